@@ -1,5 +1,7 @@
 #include "RenderSystem2D.h"
 #include <array>
+#include <numeric>
+#include <span>
 #include <stdexcept>
 
 #define GLM_FORCE_RADIANS
@@ -19,6 +21,9 @@ vmv::RenderSystem2D::RenderSystem2D(VMVDevice& device, VkRenderPass renderPass)
 
 vmv::RenderSystem2D::~RenderSystem2D()
 {
+    // the layout must outlive the compiles
+    m_VMVPipeline.Wait();
+    m_PackedPipeline.Wait();
     vkDestroyPipelineLayout(m_VMVDevice.device(), m_PipelineLayout, nullptr);
 }
 
@@ -52,27 +57,55 @@ void vmv::RenderSystem2D::CreatePipeline(VkRenderPass renderPass)
 
     pipelineConfig.renderPass = renderPass;
     pipelineConfig.pipelineLayout = m_PipelineLayout;
-    m_pVMVPipeline = std::make_unique<VMVPipeline>(
-        m_VMVDevice, pipelineConfig, "Shaders/shader_2D.vert.spv", "Shaders/shader_2D.frag.spv");
+    VMVPipelineLibrary& pipelineLibrary{m_VMVDevice.getPipelineLibrary()};
+    m_VMVPipeline = pipelineLibrary.RequestGraphicsPipeline(
+        pipelineConfig, "Shaders/shader_2D.vert.spv", "Shaders/shader_2D.frag.spv");
+
+    pipelineConfig.bindingDescriptions = VMVModel::PackedVertex::GetBindingDescriptions();
+    pipelineConfig.attributeDescriptions = VMVModel::PackedVertex::GetAttributeDescriptions();
+    m_PackedPipeline = pipelineLibrary.RequestGraphicsPipeline(
+        pipelineConfig, "Shaders/shader_2D_packed.vert.spv", "Shaders/shader_2D.frag.spv");
+}
+
+vmv::VMVPipeline* vmv::RenderSystem2D::GetPipeline(const VMVModel& model) const
+{
+    return model.GetVertexFormat() == VMVModel::VertexFormat::Packed ? m_PackedPipeline.TryGet()
+                                                                      : m_VMVPipeline.TryGet();
 }
 
-void vmv::RenderSystem2D::DrawGameObjects(VMVFrameInfo& frameInfo, std::vector<VMVGameObject>& gameObjects)
+void vmv::RenderSystem2D::DrawScene(VMVFrameInfo& frameInfo, VMVScene& scene)
 {
-    m_pVMVPipeline->Bind(frameInfo.commandBuffer);
+    // No depth in the key, the 2D shaders ignore the camera
+    m_DrawOrder.resize(scene.GetEntityCount());
+    std::iota(m_DrawOrder.begin(), m_DrawOrder.end(), 0u);
+    m_DrawSorter.Sort(scene, m_DrawOrder, nullptr);
 
-    for (VMVGameObject& go : gameObjects)
+    const std::span<const Transform> transforms{scene.GetTransforms()};
+    const std::span<const VMVScene::ModelId> modelIds{scene.GetModelIds()};
+    for (uint32_t i : m_DrawOrder)
     {
+        const VMVModel& model{scene.GetModel(modelIds[i])};
+        VMVPipeline* pPipeline{GetPipeline(model)};
+        if (pPipeline == nullptr)
+            continue;
+
+        pPipeline->Bind(frameInfo.commandState);
+
         ObjectTransformPushConstant push{};
-        push.model = go.m_Transform.GetMat();
+        push.model = transforms[i].GetMat();
+        if (model.GetVertexFormat() == VMVModel::VertexFormat::Packed)
+        {
+            push.model = push.model * model.GetDequantizeMatrix();
+        }
 
-        vkCmdPushConstants(frameInfo.commandBuffer,
-                           m_PipelineLayout,
-                           VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
-                           0,
-                           sizeof(ObjectTransformPushConstant),
-                           &push);
+        frameInfo.commandState.PushConstants(m_PipelineLayout,
+                                             VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+                                             0,
+                                             sizeof(ObjectTransformPushConstant),
+                                             &push);
 
-        go.m_Model->Bind(frameInfo.commandBuffer);
-        go.m_Model->Draw(frameInfo.commandBuffer);
+        model.Bind(frameInfo.commandState);
+        model.Draw(frameInfo.commandBuffer);
     }
+    frameInfo.commandState.FlushStats(frameInfo.stats);
 }
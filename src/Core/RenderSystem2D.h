@@ -3,9 +3,11 @@
 
 #include "VMVCamera.h"
 #include "VMVDevice.h"
+#include "VMVDrawSorter.h"
 #include "VMVFrameInfo.h"
-#include "VMVGameObject.h"
 #include "VMVPipeline.h"
+#include "VMVPipelineLibrary.h"
+#include "VMVScene.h"
 
 #include <memory>
 #include <vector>
@@ -23,7 +25,11 @@ namespace vmv
         RenderSystem2D& operator=(const RenderSystem2D&) = delete;
         RenderSystem2D& operator=(RenderSystem2D&&) noexcept = delete;
 
-        void DrawGameObjects(VMVFrameInfo& frameInfo, std::vector<VMVGameObject>& gameObjects);
+        // Skips the entities whose pipeline is still compiling
+        void DrawScene(VMVFrameInfo& frameInfo, VMVScene& scene);
+
+        // Throws once a pipeline failed to compile
+        bool ArePipelinesReady() const { return m_VMVPipeline.IsReady() && m_PackedPipeline.IsReady(); }
 
       private:
         struct ObjectTransformPushConstant
@@ -32,11 +38,16 @@ namespace vmv
         };
 
         VMVDevice& m_VMVDevice;
-        std::unique_ptr<VMVPipeline> m_pVMVPipeline;
+        VMVPipelineHandle m_VMVPipeline;
+        VMVPipelineHandle m_PackedPipeline;
         VkPipelineLayout m_PipelineLayout;
 
+        VMVDrawSorter m_DrawSorter{};
+        std::vector<uint32_t> m_DrawOrder{}; // dense indices of the scene's entities, sorted by state
+
         void CreatePipelineLayout();
         void CreatePipeline(VkRenderPass renderPass);
+        VMVPipeline* GetPipeline(const VMVModel& model) const; // nullptr while the pipeline is compiling
 	};
 } // namespace vmv
 
@@ -1,5 +1,11 @@
 #include "SimpleRenderSystem.h"
+#include <algorithm>
 #include <array>
+#include <bit>
+#include <cassert>
+#include <chrono>
+#include <numeric>
+#include <span>
 #include <stdexcept>
 
 #define GLM_FORCE_RADIANS
@@ -22,10 +28,21 @@ vmv::SimpleRenderSystem::SimpleRenderSystem(VMVDevice& device, VkRenderPass rend
 
     CreateDescriptorPool();
     CreateDescriptorSets();
+
+    // Culling writes per group instance ranges that only indirect draws can consume
+    if (m_VMVDevice.supportsDrawIndirectFirstInstance())
+    {
+        m_pGpuCuller = std::make_unique<VMVGpuCuller>(m_VMVDevice, VMVSwapChain::MAX_FRAMES_IN_FLIGHT);
+    }
 }
 
 vmv::SimpleRenderSystem::~SimpleRenderSystem()
 {
+    // The layout must outlive the compiles, Wait because a destructor must not throw
+    m_VMVPipeline.Wait();
+    m_PackedPipeline.Wait();
+    m_InstancedPipeline.Wait();
+    m_PackedInstancedPipeline.Wait();
     vkDestroyPipelineLayout(m_VMVDevice.device(), m_PipelineLayout, nullptr);
     vkDestroyDescriptorPool(m_VMVDevice.device(), m_DescriptorPool, nullptr);
     vkDestroyDescriptorSetLayout(m_VMVDevice.device(), m_DescriptorSetLayout, nullptr);
@@ -61,8 +78,46 @@ void vmv::SimpleRenderSystem::CreatePipeline(VkRenderPass renderPass)
 
     pipelineConfig.renderPass = renderPass;
     pipelineConfig.pipelineLayout = m_PipelineLayout;
-    m_pVMVPipeline = std::make_unique<VMVPipeline>(
-        m_VMVDevice, pipelineConfig, "Shaders/simple_shader.vert.spv", "Shaders/simple_shader.frag.spv");
+
+    // Requested in the order the default draw mode needs them
+    VMVPipelineLibrary& pipelineLibrary{m_VMVDevice.getPipelineLibrary()};
+    m_InstancedPipeline = pipelineLibrary.RequestGraphicsPipeline(
+        pipelineConfig, "Shaders/simple_shader_instanced.vert.spv", "Shaders/simple_shader.frag.spv");
+    m_VMVPipeline = pipelineLibrary.RequestGraphicsPipeline(
+        pipelineConfig, "Shaders/simple_shader.vert.spv", "Shaders/simple_shader.frag.spv");
+
+    pipelineConfig.bindingDescriptions = VMVModel::PackedVertex::GetBindingDescriptions();
+    pipelineConfig.attributeDescriptions = VMVModel::PackedVertex::GetAttributeDescriptions();
+    m_PackedInstancedPipeline = pipelineLibrary.RequestGraphicsPipeline(
+        pipelineConfig, "Shaders/simple_shader_packed_instanced.vert.spv", "Shaders/simple_shader.frag.spv");
+    m_PackedPipeline = pipelineLibrary.RequestGraphicsPipeline(
+        pipelineConfig, "Shaders/simple_shader_packed.vert.spv", "Shaders/simple_shader.frag.spv");
+}
+
+vmv::VMVPipeline* vmv::SimpleRenderSystem::GetPipeline(const VMVModel& model) const
+{
+    return model.GetVertexFormat() == VMVModel::VertexFormat::Packed ? m_PackedPipeline.TryGet()
+                                                                      : m_VMVPipeline.TryGet();
+}
+
+vmv::VMVPipeline* vmv::SimpleRenderSystem::GetInstancedPipeline(const VMVModel& model) const
+{
+    return model.GetVertexFormat() == VMVModel::VertexFormat::Packed ? m_PackedInstancedPipeline.TryGet()
+                                                                      : m_InstancedPipeline.TryGet();
+}
+
+bool vmv::SimpleRenderSystem::ArePipelinesReady() const
+{
+    return m_VMVPipeline.IsReady() && m_PackedPipeline.IsReady() && m_InstancedPipeline.IsReady() &&
+           m_PackedInstancedPipeline.IsReady();
+}
+
+void vmv::SimpleRenderSystem::WaitForPipelines() const
+{
+    m_VMVPipeline.Get();
+    m_PackedPipeline.Get();
+    m_InstancedPipeline.Get();
+    m_PackedInstancedPipeline.Get();
 }
 
 void vmv::SimpleRenderSystem::CreateDescriptorSetLayout()
@@ -74,7 +129,13 @@ void vmv::SimpleRenderSystem::CreateDescriptorSetLayout()
     globalUboBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
     globalUboBinding.pImmutableSamplers = nullptr; // for image sampling
 
-    std::vector<VkDescriptorSetLayoutBinding> bindings{globalUboBinding};
+    VkDescriptorSetLayoutBinding instanceBinding{};
+    instanceBinding.binding = 1;
+    instanceBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    instanceBinding.descriptorCount = 1;
+    instanceBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+
+    std::vector<VkDescriptorSetLayoutBinding> bindings{globalUboBinding, instanceBinding};
 
     VkDescriptorSetLayoutCreateInfo layoutInfo{};
     layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
@@ -101,19 +162,55 @@ void vmv::SimpleRenderSystem::CreateUniformBuffers()
                                         m_VMVDevice.properties.limits.minUniformBufferOffsetAlignment);
         m_GlobalUboBuffers[i]->map();
     }
+
+    m_InstanceBuffers.resize(VMVSwapChain::MAX_FRAMES_IN_FLIGHT);
+    m_IndirectBuffers.resize(VMVSwapChain::MAX_FRAMES_IN_FLIGHT);
+    m_DrawCountBuffers.resize(VMVSwapChain::MAX_FRAMES_IN_FLIGHT);
+}
+
+void vmv::SimpleRenderSystem::CreateInstanceBuffer(size_t frameIndex, uint32_t instanceCapacity)
+{
+    m_InstanceBuffers[frameIndex] =
+        std::make_unique<VMVBuffer>(m_VMVDevice,
+                                    sizeof(InstanceData),
+                                    instanceCapacity,
+                                    VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    m_InstanceBuffers[frameIndex]->map();
+
+    VkDescriptorBufferInfo bufferInfo{};
+    bufferInfo.buffer = m_InstanceBuffers[frameIndex]->getBuffer();
+    bufferInfo.offset = 0;
+    bufferInfo.range = VK_WHOLE_SIZE;
+
+    VkWriteDescriptorSet descriptorWrite{};
+    descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrite.dstSet = m_DescriptorSets[frameIndex];
+    descriptorWrite.dstBinding = 1;
+    descriptorWrite.dstArrayElement = 0;
+    descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    descriptorWrite.descriptorCount = 1;
+    descriptorWrite.pBufferInfo = &bufferInfo;
+
+    vkUpdateDescriptorSets(m_VMVDevice.device(), 1, &descriptorWrite, 0, nullptr);
 }
 
 void vmv::SimpleRenderSystem::CreateDescriptorPool()
 {
-    VkDescriptorPoolSize poolSize{};
-    poolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    poolSize.descriptorCount = static_cast<uint32_t>(VMVSwapChain::MAX_FRAMES_IN_FLIGHT);
+    // A regular and a culled set per frame
+    const uint32_t setCount{static_cast<uint32_t>(VMVSwapChain::MAX_FRAMES_IN_FLIGHT) * 2};
+
+    std::array<VkDescriptorPoolSize, 2> poolSizes{};
+    poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    poolSizes[0].descriptorCount = setCount;
+    poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSizes[1].descriptorCount = setCount;
 
     VkDescriptorPoolCreateInfo poolInfo{};
     poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-    poolInfo.poolSizeCount = 1;
-    poolInfo.pPoolSizes = &poolSize;
-    poolInfo.maxSets = static_cast<uint32_t>(VMVSwapChain::MAX_FRAMES_IN_FLIGHT);
+    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolInfo.pPoolSizes = poolSizes.data();
+    poolInfo.maxSets = setCount;
 
     if (vkCreateDescriptorPool(m_VMVDevice.device(), &poolInfo, nullptr, &m_DescriptorPool) != VK_SUCCESS)
     {
@@ -123,18 +220,21 @@ void vmv::SimpleRenderSystem::CreateDescriptorPool()
 
 void vmv::SimpleRenderSystem::CreateDescriptorSets()
 {
-    std::vector<VkDescriptorSetLayout> layouts{VMVSwapChain::MAX_FRAMES_IN_FLIGHT, m_DescriptorSetLayout};
+    std::vector<VkDescriptorSetLayout> layouts{VMVSwapChain::MAX_FRAMES_IN_FLIGHT * 2, m_DescriptorSetLayout};
     VkDescriptorSetAllocateInfo allocInfo{};
     allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
     allocInfo.descriptorPool = m_DescriptorPool;
-    allocInfo.descriptorSetCount = static_cast<uint32_t>(VMVSwapChain::MAX_FRAMES_IN_FLIGHT);
+    allocInfo.descriptorSetCount = static_cast<uint32_t>(layouts.size());
     allocInfo.pSetLayouts = layouts.data();
 
-    m_DescriptorSets.resize(VMVSwapChain::MAX_FRAMES_IN_FLIGHT);
-    if (vkAllocateDescriptorSets(m_VMVDevice.device(), &allocInfo, m_DescriptorSets.data()) != VK_SUCCESS)
+    std::vector<VkDescriptorSet> descriptorSets(layouts.size());
+    if (vkAllocateDescriptorSets(m_VMVDevice.device(), &allocInfo, descriptorSets.data()) != VK_SUCCESS)
     {
         throw std::runtime_error{"Failed to allocate Descriptor Sets!"};
     }
+    m_DescriptorSets.assign(descriptorSets.begin(), descriptorSets.begin() + VMVSwapChain::MAX_FRAMES_IN_FLIGHT);
+    m_CulledDescriptorSets.assign(descriptorSets.begin() + VMVSwapChain::MAX_FRAMES_IN_FLIGHT, descriptorSets.end());
+    m_CulledInstanceBuffers.assign(VMVSwapChain::MAX_FRAMES_IN_FLIGHT, VK_NULL_HANDLE);
 
     for (size_t i{}; i < m_DescriptorSets.size(); ++i)
     {
@@ -155,41 +255,543 @@ void vmv::SimpleRenderSystem::CreateDescriptorSets()
         // descriptorWrite.pImageInfo = nullptr; // If this was an image buffer use this to set the texture
 
         vkUpdateDescriptorSets(m_VMVDevice.device(), 1, &descriptorWrite, 0, nullptr);
+
+        descriptorWrite.dstSet = m_CulledDescriptorSets[i];
+        vkUpdateDescriptorSets(m_VMVDevice.device(), 1, &descriptorWrite, 0, nullptr);
+
+        CreateInstanceBuffer(i, MIN_INSTANCE_CAPACITY);
     }
 }
 
-void vmv::SimpleRenderSystem::DrawGameObjects(VMVFrameInfo& frameInfo, std::vector<VMVGameObject>& gameObjects)
+void vmv::SimpleRenderSystem::UpdateCulledDescriptorSet(size_t frameIndex)
+{
+    const VMVBuffer& visibleInstanceBuffer{m_pGpuCuller->GetVisibleInstanceBuffer(frameIndex)};
+    if (visibleInstanceBuffer.getBuffer() == m_CulledInstanceBuffers[frameIndex])
+        return;
+
+    VkDescriptorBufferInfo bufferInfo{};
+    bufferInfo.buffer = visibleInstanceBuffer.getBuffer();
+    bufferInfo.offset = 0;
+    bufferInfo.range = VK_WHOLE_SIZE;
+
+    VkWriteDescriptorSet descriptorWrite{};
+    descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrite.dstSet = m_CulledDescriptorSets[frameIndex];
+    descriptorWrite.dstBinding = 1;
+    descriptorWrite.dstArrayElement = 0;
+    descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    descriptorWrite.descriptorCount = 1;
+    descriptorWrite.pBufferInfo = &bufferInfo;
+
+    vkUpdateDescriptorSets(m_VMVDevice.device(), 1, &descriptorWrite, 0, nullptr);
+    m_CulledInstanceBuffers[frameIndex] = visibleInstanceBuffer.getBuffer();
+}
+
+vmv::SimpleRenderSystem::DrawMode vmv::SimpleRenderSystem::GetEffectiveDrawMode() const
+{
+    // Indirect draws with a non-zero firstInstance need drawIndirectFirstInstance
+    if (m_DrawMode == DrawMode::Indirect && !m_VMVDevice.supportsDrawIndirectFirstInstance())
+        return DrawMode::Instanced;
+
+    return m_DrawMode;
+}
+
+void vmv::SimpleRenderSystem::PrepareScene(VMVFrameInfo& frameInfo, VMVScene& scene)
 {
-    m_pVMVPipeline->Bind(frameInfo.commandBuffer);
+    m_IsPrepared = false;
+    if (GetEffectiveDrawMode() != DrawMode::Indirect || m_CullMode != CullMode::Gpu || !m_pGpuCuller)
+        return;
 
-    // glm::mat4 projectionView{frameInfo.camera.GetProjection() * frameInfo.camera.GetView()};
+    using namespace std::chrono;
+    const time_point start{high_resolution_clock::now()};
+
+    const size_t frameIndex{static_cast<size_t>(frameInfo.frameIndex)};
+    SelectVisibleObjects(frameInfo, scene, false);
+    const uint32_t instanceCount{WriteInstances(frameInfo, scene, true)};
+    WriteIndirectCommands(frameIndex, true);
+
+    VMVGpuCuller::Group* pGroups{m_pGpuCuller->MapGroups(frameIndex, static_cast<uint32_t>(m_GroupModels.size()))};
+    for (size_t i{}; i < m_GroupModels.size(); ++i)
+    {
+        const VMVModel& model{*m_GroupModels[i]};
+        pGroups[i].boundingSphere = model.GetVertexBoundingSphere();
+        pGroups[i].firstCommand = m_GroupFirstCommands[i];
+        pGroups[i].commandCount = model.IsIndexed() ? model.GetDrawCount() : 0;
+    }
+
+    m_pGpuCuller->Dispatch(frameInfo.commandBuffer,
+                           frameIndex,
+                           frameInfo.camera.GetFrustumPlanes(),
+                           *m_InstanceBuffers[frameIndex],
+                           instanceCount,
+                           *m_IndirectBuffers[frameIndex]);
+    if (instanceCount > 0)
+    {
+        // Before DrawScene or RecordScene binds it, like the instance buffer
+        assert(!frameInfo.commandState.IsBound(m_CulledDescriptorSets[frameIndex]) &&
+               "The culled descriptor set has to be written before it is bound!");
+        UpdateCulledDescriptorSet(frameIndex);
+    }
+
+    // The GPU counts come from this frame slot's previous submission
+    const VMVGpuCuller::Stats& cullStats{m_pGpuCuller->GetStats(frameIndex)};
+    frameInfo.stats.visibleObjects += cullStats.visibleCount;
+    frameInfo.stats.culledObjects += cullStats.culledCount;
+
+    m_IsPrepared = instanceCount > 0;
+    frameInfo.stats.recordTime +=
+        duration<float, milliseconds::period>(high_resolution_clock::now() - start).count();
+}
+
+bool vmv::SimpleRenderSystem::WriteFrameData(VMVFrameInfo& frameInfo, VMVScene& scene)
+{
+    const size_t frameIndex{static_cast<size_t>(frameInfo.frameIndex)};
+    const bool isCulled{m_IsPrepared};
+    m_IsPrepared = false;
 
     UpdateGlobalUbo(frameInfo);
-    vkCmdBindDescriptorSets(frameInfo.commandBuffer,
-                            VK_PIPELINE_BIND_POINT_GRAPHICS,
-                            m_PipelineLayout,
-                            0,
-                            1,
-                            &m_DescriptorSets[frameInfo.frameIndex],
-                            0,
-                            nullptr);
 
-    for (VMVGameObject& go : gameObjects)
+    if (!isCulled)
+    {
+        SelectVisibleObjects(frameInfo, scene, m_CullMode != CullMode::None);
+        frameInfo.stats.visibleObjects += static_cast<uint32_t>(m_VisibleObjects.size());
+        frameInfo.stats.culledObjects += static_cast<uint32_t>(scene.GetEntityCount() - m_VisibleObjects.size());
+    }
+
+    // Instances are only counted here and in WriteInstances, on this thread, never by the draws
+    switch (GetEffectiveDrawMode())
+    {
+    case DrawMode::PerObject:
+        frameInfo.stats.instances += static_cast<uint32_t>(m_VisibleObjects.size());
+        break;
+    case DrawMode::Instanced:
+        WriteInstances(frameInfo, scene);
+        break;
+    case DrawMode::Indirect:
+        if (!isCulled)
+        {
+            WriteInstances(frameInfo, scene);
+            WriteIndirectCommands(frameIndex, false);
+        }
+        break;
+    }
+    return isCulled;
+}
+
+void vmv::SimpleRenderSystem::BindDescriptorSet(VMVCommandState& commandState, size_t frameIndex, bool isCulled) const
+{
+    commandState.BindDescriptorSet(VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                   m_PipelineLayout,
+                                   0,
+                                   isCulled ? m_CulledDescriptorSets[frameIndex] : m_DescriptorSets[frameIndex]);
+}
+
+void vmv::SimpleRenderSystem::DrawScene(VMVFrameInfo& frameInfo, VMVScene& scene)
+{
+    using namespace std::chrono;
+    const time_point start{high_resolution_clock::now()};
+
+    // WriteFrameData may grow the instance buffer and update the descriptor set, so it has to come first
+    const bool isCulled{WriteFrameData(frameInfo, scene)};
+    BindDescriptorSet(frameInfo.commandState, static_cast<size_t>(frameInfo.frameIndex), isCulled);
+
+    switch (GetEffectiveDrawMode())
+    {
+    case DrawMode::PerObject:
+        DrawPerObject(frameInfo, scene, 0, m_VisibleObjects.size());
+        break;
+    case DrawMode::Instanced:
+        DrawInstanced(frameInfo, 0, m_GroupModels.size());
+        break;
+    case DrawMode::Indirect:
+        DrawIndirect(frameInfo);
+        break;
+    }
+    frameInfo.commandState.FlushStats(frameInfo.stats);
+
+    frameInfo.stats.recordTime +=
+        duration<float, milliseconds::period>(high_resolution_clock::now() - start).count();
+}
+
+void vmv::SimpleRenderSystem::RecordScene(VMVFrameInfo& frameInfo,
+                                          VMVScene& scene,
+                                          VMVRenderer& renderer,
+                                          VMVThreadPool& threadPool,
+                                          std::vector<VkCommandBuffer>& outCommandBuffers)
+{
+    using namespace std::chrono;
+    const time_point start{high_resolution_clock::now()};
+
+    // Buffers and descriptor sets are written on this thread before any task binds them, the workers only record
+    const size_t frameIndex{static_cast<size_t>(frameInfo.frameIndex)};
+    const bool isCulled{WriteFrameData(frameInfo, scene)};
+    const DrawMode drawMode{GetEffectiveDrawMode()};
+
+    // Tasks record contiguous ranges of objects or groups. A few tasks per thread even out uneven ranges, the
+    // indirect draws are a handful of multi-draws and stay in one task.
+    size_t itemCount{1};
+    size_t minItemsPerTask{1};
+    if (drawMode == DrawMode::PerObject)
     {
+        itemCount = m_VisibleObjects.size();
+        minItemsPerTask = MIN_OBJECTS_PER_TASK;
+    }
+    else if (drawMode == DrawMode::Instanced)
+    {
+        itemCount = m_GroupModels.size();
+    }
+
+    const uint32_t taskCount{static_cast<uint32_t>(std::min<size_t>(
+        threadPool.GetThreadCount() * TASKS_PER_THREAD, (itemCount + minItemsPerTask - 1) / minItemsPerTask))};
+    const size_t firstCommandBuffer{outCommandBuffers.size()};
+    outCommandBuffers.resize(firstCommandBuffer + taskCount);
+    m_TaskStats.assign(taskCount, {});
+
+    threadPool.ParallelFor(taskCount, [&](uint32_t taskIndex, uint32_t threadIndex) {
+        const size_t first{itemCount * taskIndex / taskCount};
+        const size_t count{itemCount * (taskIndex + 1) / taskCount - first};
+
+        VkCommandBuffer commandBuffer{renderer.BeginSecondaryCommandBuffer(threadIndex)};
+        VMVFrameInfo taskInfo{frameInfo.frameIndex, frameInfo.frameTime, commandBuffer, frameInfo.camera};
+        BindDescriptorSet(taskInfo.commandState, frameIndex, isCulled);
+
+        switch (drawMode)
+        {
+        case DrawMode::PerObject:
+            DrawPerObject(taskInfo, scene, first, count);
+            break;
+        case DrawMode::Instanced:
+            DrawInstanced(taskInfo, first, count);
+            break;
+        case DrawMode::Indirect:
+            DrawIndirect(taskInfo);
+            break;
+        }
+
+        renderer.EndSecondaryCommandBuffer(taskInfo.commandBuffer);
+        outCommandBuffers[firstCommandBuffer + taskIndex] = taskInfo.commandBuffer;
+        taskInfo.commandState.FlushStats(taskInfo.stats);
+        m_TaskStats[taskIndex] = taskInfo.stats;
+    });
+
+    for (const VMVFrameStats& taskStats : m_TaskStats)
+    {
+        frameInfo.stats.drawCalls += taskStats.drawCalls;
+        frameInfo.stats.drawCommands += taskStats.drawCommands;
+        frameInfo.stats.pipelineBinds += taskStats.pipelineBinds;
+        frameInfo.stats.bufferBinds += taskStats.bufferBinds;
+        frameInfo.stats.skippedCommands += taskStats.skippedCommands;
+    }
+
+    frameInfo.stats.recordTime +=
+        duration<float, milliseconds::period>(high_resolution_clock::now() - start).count();
+}
+
+void vmv::SimpleRenderSystem::SelectVisibleObjects(VMVFrameInfo& frameInfo, const VMVScene& scene, bool cull)
+{
+    if (cull)
+    {
+        const std::span<const Transform> transforms{scene.GetTransforms()};
+        const std::span<const VMVScene::ModelId> modelIds{scene.GetModelIds()};
+        m_FrustumCuller.Resize(transforms.size());
+        for (size_t i{}; i < transforms.size(); ++i)
+        {
+            const glm::vec4& sphere{scene.GetModel(modelIds[i]).GetBoundingSphere()};
+            const glm::vec3 scale{glm::abs(transforms[i].GetScale())};
+            const glm::vec4 center{transforms[i].GetMat() * glm::vec4{glm::vec3{sphere}, 1.f}};
+            m_FrustumCuller.SetSphere(i, glm::vec3{center}, sphere.w * std::max({scale.x, scale.y, scale.z}));
+        }
+        m_FrustumCuller.Cull(frameInfo.camera.GetFrustumPlanes(), m_VisibleObjects);
+    }
+    else
+    {
+        m_VisibleObjects.resize(scene.GetEntityCount());
+        std::iota(m_VisibleObjects.begin(), m_VisibleObjects.end(), 0u);
+    }
+
+    // WriteInstances keeps this order, so it also sorts the groups and the instances within them
+    if (m_IsSortingDraws)
+    {
+        m_DrawSorter.Sort(scene, m_VisibleObjects, &frameInfo.camera);
+    }
+}
+
+void vmv::SimpleRenderSystem::DrawPerObject(VMVFrameInfo& frameInfo,
+                                            const VMVScene& scene,
+                                            size_t first,
+                                            size_t count) const
+{
+    const std::span<const Transform> transforms{scene.GetTransforms()};
+    const std::span<const VMVScene::ModelId> modelIds{scene.GetModelIds()};
+    for (size_t i{first}; i < first + count; ++i)
+    {
+        const uint32_t entity{m_VisibleObjects[i]};
+        const VMVModel& model{scene.GetModel(modelIds[entity])};
+        VMVPipeline* pPipeline{GetPipeline(model)};
+        if (pPipeline == nullptr)
+            continue;
+
+        pPipeline->Bind(frameInfo.commandState);
+
         ObjectTransformPushConstant push{};
-        push.model = go.m_Transform.GetMat();
-        push.normalMatrix = go.m_Transform.NormalMatrix();
+        push.model = transforms[entity].GetMat();
+        push.normalMatrix = transforms[entity].NormalMatrix();
+        if (model.GetVertexFormat() == VMVModel::VertexFormat::Packed)
+        {
+            push.model = push.model * model.GetDequantizeMatrix();
+        }
+
+        frameInfo.commandState.PushConstants(m_PipelineLayout,
+                                             VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+                                             0,
+                                             sizeof(ObjectTransformPushConstant),
+                                             &push);
+
+        model.Bind(frameInfo.commandState);
+        model.Draw(frameInfo.commandBuffer);
+
+        const uint32_t drawCount{model.GetDrawCount()};
+        frameInfo.stats.drawCalls += drawCount;
+        frameInfo.stats.drawCommands += drawCount;
+    }
+}
 
-        vkCmdPushConstants(frameInfo.commandBuffer,
-                           m_PipelineLayout,
-                           VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
-                           0,
-                           sizeof(ObjectTransformPushConstant),
-                           &push);
+uint32_t vmv::SimpleRenderSystem::WriteInstances(VMVFrameInfo& frameInfo,
+                                                 const VMVScene& scene,
+                                                 bool writeInstanceGroups)
+{
+    const std::span<const Transform> transforms{scene.GetTransforms()};
+    const std::span<const VMVScene::ModelId> modelIds{scene.GetModelIds()};
+    m_GroupModels.clear();
+    m_GroupOffsets.clear();
+    m_ObjectGroups.resize(m_VisibleObjects.size());
+    m_ModelGroups.assign(scene.GetModelCount(), NO_GROUP);
+
+    // Counting sort by model so every model's instances are contiguous, groups keep first-seen order
+    for (size_t i{}; i < m_VisibleObjects.size(); ++i)
+    {
+        const VMVScene::ModelId modelId{modelIds[m_VisibleObjects[i]]};
+        uint32_t& group{m_ModelGroups[modelId]};
+        if (group == NO_GROUP)
+        {
+            group = static_cast<uint32_t>(m_GroupModels.size());
+            m_GroupModels.push_back(&scene.GetModel(modelId));
+            m_GroupOffsets.push_back(0);
+        }
+        m_ObjectGroups[i] = group;
+        ++m_GroupOffsets[group];
+    }
+
+    m_GroupCounts = m_GroupOffsets;
+    uint32_t instanceCount{};
+    for (uint32_t& offset : m_GroupOffsets)
+    {
+        const uint32_t count{offset};
+        offset = instanceCount;
+        instanceCount += count;
+    }
 
-        go.m_Model->Bind(frameInfo.commandBuffer);
-        go.m_Model->Draw(frameInfo.commandBuffer);
+    if (instanceCount == 0)
+        return 0;
+
+    std::unique_ptr<VMVBuffer>& instanceBuffer{m_InstanceBuffers[frameInfo.frameIndex]};
+    if (instanceBuffer->getInstanceCount() < instanceCount)
+    {
+        // Safe to replace, the frame using this buffer last has been waited on before recording started. Updating
+        // the descriptor set is not once it is bound, so callers write the instances first and bind afterwards.
+        assert(!frameInfo.commandState.IsBound(m_DescriptorSets[frameInfo.frameIndex]) &&
+               "Instances have to be written before the descriptor set is bound!");
+        CreateInstanceBuffer(frameInfo.frameIndex, std::bit_ceil(instanceCount));
     }
+
+    InstanceData* pInstances{static_cast<InstanceData*>(instanceBuffer->getMappedMemory())};
+    uint32_t* pInstanceGroups{
+        writeInstanceGroups ? m_pGpuCuller->MapInstanceGroups(frameInfo.frameIndex, instanceCount) : nullptr};
+    m_WriteOffsets = m_GroupOffsets;
+    for (size_t i{}; i < m_VisibleObjects.size(); ++i)
+    {
+        const uint32_t entity{m_VisibleObjects[i]};
+        const uint32_t instanceIndex{m_WriteOffsets[m_ObjectGroups[i]]++};
+        if (pInstanceGroups != nullptr)
+        {
+            pInstanceGroups[instanceIndex] = m_ObjectGroups[i];
+        }
+
+        InstanceData& instance{pInstances[instanceIndex]};
+        instance.model = transforms[entity].GetMat();
+        instance.normalMatrix = transforms[entity].NormalMatrix();
+        const VMVModel& model{*m_GroupModels[m_ObjectGroups[i]]};
+        if (model.GetVertexFormat() == VMVModel::VertexFormat::Packed)
+        {
+            instance.model = instance.model * model.GetDequantizeMatrix();
+        }
+    }
+
+    frameInfo.stats.instances += instanceCount;
+    return instanceCount;
+}
+
+void vmv::SimpleRenderSystem::DrawInstanced(VMVFrameInfo& frameInfo, size_t firstGroup, size_t groupCount) const
+{
+    for (size_t i{firstGroup}; i < firstGroup + groupCount; ++i)
+    {
+        const VMVModel& model{*m_GroupModels[i]};
+        VMVPipeline* pPipeline{GetInstancedPipeline(model)};
+        if (pPipeline == nullptr)
+            continue;
+
+        pPipeline->Bind(frameInfo.commandState);
+        model.Bind(frameInfo.commandState);
+
+        model.Draw(frameInfo.commandBuffer, m_GroupCounts[i], m_GroupOffsets[i]);
+        frameInfo.stats.drawCalls += model.GetDrawCount();
+        frameInfo.stats.drawCommands += model.GetDrawCount();
+    }
+}
+
+void vmv::SimpleRenderSystem::WriteIndirectCommands(size_t frameIndex, bool deferInstanceCounts)
+{
+    uint32_t commandCount{};
+    for (const VMVModel* pModel : m_GroupModels)
+    {
+        commandCount += pModel->IsIndexed() ? pModel->GetDrawCount() : 0;
+    }
+
+    if (!m_IndirectBuffers[frameIndex] || m_IndirectBuffers[frameIndex]->getInstanceCount() < commandCount)
+    {
+        CreateIndirectBuffers(frameIndex, std::bit_ceil(std::max(commandCount, MIN_INSTANCE_CAPACITY)));
+    }
+
+    VkDrawIndexedIndirectCommand* pCommands{
+        static_cast<VkDrawIndexedIndirectCommand*>(m_IndirectBuffers[frameIndex]->getMappedMemory())};
+
+    // Commands follow group order, so consecutive indexed groups have consecutive commands
+    m_GroupFirstCommands.resize(m_GroupModels.size());
+    uint32_t writtenCommands{};
+    for (size_t i{}; i < m_GroupModels.size(); ++i)
+    {
+        m_GroupFirstCommands[i] = writtenCommands;
+        writtenCommands += m_GroupModels[i]->WriteIndirectCommands(
+            pCommands + writtenCommands, deferInstanceCounts ? 0 : m_GroupCounts[i], m_GroupOffsets[i]);
+    }
+}
+
+void vmv::SimpleRenderSystem::DrawIndirect(VMVFrameInfo& frameInfo) const
+{
+    const size_t frameIndex{static_cast<size_t>(frameInfo.frameIndex)};
+    if (m_GroupModels.empty())
+        return;
+
+    uint32_t* pDrawCounts{static_cast<uint32_t*>(m_DrawCountBuffers[frameIndex]->getMappedMemory())};
+
+    const PFN_vkCmdDrawIndexedIndirectCountKHR cmdDrawIndexedIndirectCount{
+        m_VMVDevice.getCmdDrawIndexedIndirectCount()};
+    const uint32_t maxDrawCount{m_VMVDevice.supportsMultiDrawIndirect()
+                                    ? m_VMVDevice.properties.limits.maxDrawIndirectCount
+                                    : 1};
+    constexpr uint32_t stride{sizeof(VkDrawIndexedIndirectCommand)};
+
+    // Consecutive groups with the same pipeline and buffers form one batch, drawn with a single multi-draw
+    uint32_t batchStart{};
+    uint32_t batchCount{};
+    const VMVPipeline* pBoundPipeline{nullptr};
+    const VMVModel* pBoundModel{nullptr};
+
+    const auto flushBatch{[&]() {
+        // Counted down rather than compared against the end, maxDrawIndirectCount is often UINT32_MAX and
+        // first + maxDrawCount would wrap
+        uint32_t first{batchStart};
+        for (uint32_t remaining{batchCount}; remaining > 0;)
+        {
+            const uint32_t drawCount{std::min(maxDrawCount, remaining)};
+            const VkDeviceSize offset{static_cast<VkDeviceSize>(first) * stride};
+            if (cmdDrawIndexedIndirectCount != nullptr)
+            {
+                // The count lives in GPU memory so later passes can build the commands on the device
+                pDrawCounts[first] = drawCount;
+                cmdDrawIndexedIndirectCount(frameInfo.commandBuffer,
+                                            m_IndirectBuffers[frameIndex]->getBuffer(),
+                                            offset,
+                                            m_DrawCountBuffers[frameIndex]->getBuffer(),
+                                            static_cast<VkDeviceSize>(first) * sizeof(uint32_t),
+                                            drawCount,
+                                            stride);
+            }
+            else
+            {
+                vkCmdDrawIndexedIndirect(
+                    frameInfo.commandBuffer, m_IndirectBuffers[frameIndex]->getBuffer(), offset, drawCount, stride);
+            }
+            ++frameInfo.stats.drawCalls;
+
+            first += drawCount;
+            remaining -= drawCount;
+        }
+        frameInfo.stats.drawCommands += batchCount;
+        batchStart += batchCount;
+        batchCount = 0;
+    }};
+
+    for (size_t i{}; i < m_GroupModels.size(); ++i)
+    {
+        const VMVModel& model{*m_GroupModels[i]};
+        VMVPipeline* pPipeline{GetInstancedPipeline(model)};
+        if (pPipeline == nullptr)
+        {
+            // Its commands stay in the buffer but fall between batches
+            flushBatch();
+            continue;
+        }
+
+        const bool needsPipeline{pPipeline != pBoundPipeline};
+        const bool needsBind{pBoundModel == nullptr || !model.SharesBuffersWith(*pBoundModel)};
+
+        if (needsPipeline || needsBind || !model.IsIndexed())
+        {
+            flushBatch();
+        }
+        if (needsPipeline)
+        {
+            pPipeline->Bind(frameInfo.commandState);
+            pBoundPipeline = pPipeline;
+        }
+        if (needsBind)
+        {
+            model.Bind(frameInfo.commandState);
+            pBoundModel = &model;
+        }
+
+        if (!model.IsIndexed())
+        {
+            model.Draw(frameInfo.commandBuffer, m_GroupCounts[i], m_GroupOffsets[i]);
+            ++frameInfo.stats.drawCalls;
+            ++frameInfo.stats.drawCommands;
+            continue;
+        }
+
+        batchStart = batchCount == 0 ? m_GroupFirstCommands[i] : batchStart;
+        batchCount += model.GetDrawCount();
+    }
+    flushBatch();
+}
+
+void vmv::SimpleRenderSystem::CreateIndirectBuffers(size_t frameIndex, uint32_t commandCapacity)
+{
+    m_IndirectBuffers[frameIndex] =
+        std::make_unique<VMVBuffer>(m_VMVDevice,
+                                    sizeof(VkDrawIndexedIndirectCommand),
+                                    commandCapacity,
+                                    VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    m_IndirectBuffers[frameIndex]->map();
+
+    m_DrawCountBuffers[frameIndex] =
+        std::make_unique<VMVBuffer>(m_VMVDevice,
+                                    sizeof(uint32_t),
+                                    commandCapacity,
+                                    VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                                    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    m_DrawCountBuffers[frameIndex]->map();
 }
 
 void vmv::SimpleRenderSystem::UpdateGlobalUbo(const VMVFrameInfo& frameInfo)
@@ -3,9 +3,15 @@
 
 #include "VMVCamera.h"
 #include "VMVDevice.h"
+#include "VMVDrawSorter.h"
 #include "VMVFrameInfo.h"
-#include "VMVGameObject.h"
+#include "VMVFrustumCuller.h"
+#include "VMVGpuCuller.h"
 #include "VMVPipeline.h"
+#include "VMVPipelineLibrary.h"
+#include "VMVRenderer.h"
+#include "VMVScene.h"
+#include "VMVThreadPool.h"
 
 #include <memory>
 #include <vector>
@@ -15,6 +21,7 @@ namespace vmv
     class SimpleRenderSystem
     {
       public:
+        // The pipelines are compiled in the background, draws needing one that isn't ready yet are skipped
         SimpleRenderSystem(VMVDevice& device, VkRenderPass renderPass);
         ~SimpleRenderSystem();
 
@@ -23,7 +30,48 @@ namespace vmv
         SimpleRenderSystem& operator=(const SimpleRenderSystem&) = delete;
         SimpleRenderSystem& operator=(SimpleRenderSystem&&) noexcept = delete;
 
-        void DrawGameObjects(VMVFrameInfo& frameInfo, std::vector<VMVGameObject>& gameObjects);
+        // Frustum culls the entities on the GPU if drawing Indirect with CullMode::Gpu. Records a compute
+        // dispatch, so call it before the render pass begins, the next DrawScene draws the result.
+        void PrepareScene(VMVFrameInfo& frameInfo, VMVScene& scene);
+        void DrawScene(VMVFrameInfo& frameInfo, VMVScene& scene);
+
+        // Same as DrawScene, but records into secondary command buffers of the renderer on the thread pool's
+        // workers. Appends them to outCommandBuffers in the order they have to be executed.
+        void RecordScene(VMVFrameInfo& frameInfo,
+                         VMVScene& scene,
+                         VMVRenderer& renderer,
+                         VMVThreadPool& threadPool,
+                         std::vector<VkCommandBuffer>& outCommandBuffers);
+
+        enum class DrawMode
+        {
+            PerObject, // push constants and one draw per object
+            Instanced, // objects sharing a model in one instanced draw, transforms in a per-frame storage buffer
+            Indirect   // instanced draws as indirect commands, consecutive compatible models in one multi-draw
+        };
+
+        // Indirect falls back to Instanced on devices without drawIndirectFirstInstance
+        void SetDrawMode(DrawMode drawMode) { m_DrawMode = drawMode; }
+        DrawMode GetDrawMode() const { return m_DrawMode; }
+
+        enum class CullMode
+        {
+            None,
+            Cpu, // bounding spheres tested with SIMD in DrawScene, works in every draw mode
+            Gpu  // compute pass in PrepareScene, falls back to Cpu when not drawing Indirect
+        };
+
+        void SetCullMode(CullMode cullMode) { m_CullMode = cullMode; }
+        CullMode GetCullMode() const { return m_CullMode; }
+
+        // Sorts the visible entities by pipeline, buffers, model and front to back depth before drawing, so
+        // fewer binds are recorded and the instanced groups come out in the same order
+        void SetDrawSorting(bool isSortingDraws) { m_IsSortingDraws = isSortingDraws; }
+        bool IsSortingDraws() const { return m_IsSortingDraws; }
+
+        // Both throw once a pipeline failed to compile
+        bool ArePipelinesReady() const;
+        void WaitForPipelines() const;
 
       private:
         struct GlobalUbo // explicit because vec4 requires 4N (16byte) alignment
@@ -36,29 +84,88 @@ namespace vmv
             alignas(16) glm::mat4 model{1.f};        // for mvp
             alignas(16) glm::mat4 normalMatrix{1.f}; // for normal transformation
         };
+        struct InstanceData // std430, matches InstanceData in the *_instanced.vert shaders
+        {
+            glm::mat4 model{1.f};
+            glm::mat4 normalMatrix{1.f};
+        };
+
+        static constexpr uint32_t MIN_INSTANCE_CAPACITY{1024};
+        static constexpr size_t MIN_OBJECTS_PER_TASK{256}; // below that a task costs more than it records
+        static constexpr uint32_t TASKS_PER_THREAD{4};
 
         VMVDevice& m_VMVDevice;
 
-        std::unique_ptr<VMVPipeline> m_pVMVPipeline;
+        VMVPipelineHandle m_VMVPipeline;
+        VMVPipelineHandle m_PackedPipeline;
+        VMVPipelineHandle m_InstancedPipeline;
+        VMVPipelineHandle m_PackedInstancedPipeline;
+
+        DrawMode m_DrawMode{DrawMode::Indirect};
+
+        std::unique_ptr<VMVGpuCuller> m_pGpuCuller;
+        CullMode m_CullMode{CullMode::Gpu};
+        VMVFrustumCuller m_FrustumCuller{};
+        std::vector<uint32_t> m_VisibleObjects{}; // dense indices of the scene's entities that get drawn
+        VMVDrawSorter m_DrawSorter{};
+        bool m_IsSortingDraws{true};
+        bool m_IsPrepared{false}; // PrepareScene culled this frame, draw from the visible instances
 
         VkDescriptorSetLayout m_DescriptorSetLayout;
         VkPipelineLayout m_PipelineLayout;
 
         std::vector<std::unique_ptr<VMVBuffer>> m_GlobalUboBuffers{};
+        std::vector<std::unique_ptr<VMVBuffer>> m_InstanceBuffers{};
+        std::vector<std::unique_ptr<VMVBuffer>> m_IndirectBuffers{};
+        std::vector<std::unique_ptr<VMVBuffer>> m_DrawCountBuffers{};
+
+        static constexpr uint32_t NO_GROUP{UINT32_MAX};
+
+        // Objects grouped by model by WriteInstances, kept to avoid allocating every frame
+        std::vector<uint32_t> m_ModelGroups{}; // group of every model id, NO_GROUP if none of its entities is visible
+        std::vector<const VMVModel*> m_GroupModels{};
+        std::vector<uint32_t> m_GroupOffsets{};
+        std::vector<uint32_t> m_GroupCounts{};
+        std::vector<uint32_t> m_ObjectGroups{};
+        std::vector<uint32_t> m_WriteOffsets{};
+        std::vector<uint32_t> m_GroupFirstCommands{};
+        std::vector<VMVFrameStats> m_TaskStats{};
 
         VkDescriptorPool m_DescriptorPool;
         std::vector<VkDescriptorSet> m_DescriptorSets;
+        std::vector<VkDescriptorSet> m_CulledDescriptorSets; // instances from the culler's visible instance buffer
+        std::vector<VkBuffer> m_CulledInstanceBuffers;
 
         void CreatePipelineLayout();
         void CreatePipeline(VkRenderPass renderPass);
+        // nullptr while the pipeline is compiling
+        VMVPipeline* GetPipeline(const VMVModel& model) const;
+        VMVPipeline* GetInstancedPipeline(const VMVModel& model) const;
 
         void CreateDescriptorSetLayout();
         void CreateUniformBuffers();
+        void CreateInstanceBuffer(size_t frameIndex, uint32_t instanceCapacity);
+        void CreateIndirectBuffers(size_t frameIndex, uint32_t commandCapacity);
         void CreateDescriptorPool();
         void CreateDescriptorSets();
+        void UpdateCulledDescriptorSet(size_t frameIndex);
 
+        DrawMode GetEffectiveDrawMode() const;
         void UpdateGlobalUbo(const VMVFrameInfo& frameInfo);
+        // Everything the draws read, returns whether they have to use the culled descriptor set
+        bool WriteFrameData(VMVFrameInfo& frameInfo, VMVScene& scene);
+        void BindDescriptorSet(VMVCommandState& commandState, size_t frameIndex, bool isCulled) const;
+        void SelectVisibleObjects(VMVFrameInfo& frameInfo, const VMVScene& scene, bool cull);
+
+        // The Draw* functions only read the render system's state, so they may run on several threads at once
+        void DrawPerObject(VMVFrameInfo& frameInfo, const VMVScene& scene, size_t first, size_t count) const;
+        // Writes the objects in m_VisibleObjects, returns the number of instances written
+        uint32_t WriteInstances(VMVFrameInfo& frameInfo, const VMVScene& scene, bool writeInstanceGroups = false);
+        // With deferInstanceCounts the commands are written with instanceCount 0 for the culler to fill in
+        void WriteIndirectCommands(size_t frameIndex, bool deferInstanceCounts);
+        void DrawInstanced(VMVFrameInfo& frameInfo, size_t firstGroup, size_t groupCount) const;
+        void DrawIndirect(VMVFrameInfo& frameInfo) const;
     };
 } // namespace vmv
 
-#endif
+#endif
\ No newline at end of file
@@ -50,12 +50,14 @@ namespace vmv
     {
         unmap();
         vkDestroyBuffer(VMVDevice.device(), buffer, nullptr);
-        vkFreeMemory(VMVDevice.device(), memory, nullptr);
+        VMVDevice.getMemoryAllocator().Free(memory);
     }
 
     /**
      * Map a memory range of this buffer. If successful, mapped points to the specified buffer range.
      *
+     * @note Host visible memory is mapped persistently by VMVMemoryAllocator, this only hands out a pointer
+     *
      * @param size (Optional) Size of the memory range to map. Pass VK_WHOLE_SIZE to map the complete
      * buffer range.
      * @param offset (Optional) Byte offset from beginning
@@ -64,22 +66,24 @@ namespace vmv
      */
     VkResult VMVBuffer::map(VkDeviceSize size, VkDeviceSize offset)
     {
-        assert(buffer && memory && "Called map on buffer before create");
-        return vkMapMemory(VMVDevice.device(), memory, offset, size, 0, &mapped);
+        assert(buffer && memory.memory && "Called map on buffer before create");
+        if (memory.pMapped == nullptr)
+        {
+            return VK_ERROR_MEMORY_MAP_FAILED;
+        }
+
+        mapped = static_cast<char*>(memory.pMapped) + offset;
+        return VK_SUCCESS;
     }
 
     /**
      * Unmap a mapped memory range
      *
-     * @note Does not return a result as vkUnmapMemory can't fail
+     * @note The underlying block stays mapped until the allocator frees it
      */
     void VMVBuffer::unmap()
     {
-        if (mapped)
-        {
-            vkUnmapMemory(VMVDevice.device(), memory);
-            mapped = nullptr;
-        }
+        mapped = nullptr;
     }
 
     /**
@@ -122,8 +126,8 @@ namespace vmv
     {
         VkMappedMemoryRange mappedRange = {};
         mappedRange.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
-        mappedRange.memory = memory;
-        mappedRange.offset = offset;
+        mappedRange.memory = memory.memory;
+        mappedRange.offset = memory.offset + offset;
         mappedRange.size = size;
         return vkFlushMappedMemoryRanges(VMVDevice.device(), 1, &mappedRange);
     }
@@ -143,8 +147,8 @@ namespace vmv
     {
         VkMappedMemoryRange mappedRange = {};
         mappedRange.sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
-        mappedRange.memory = memory;
-        mappedRange.offset = offset;
+        mappedRange.memory = memory.memory;
+        mappedRange.offset = memory.offset + offset;
         mappedRange.size = size;
         return vkInvalidateMappedMemoryRanges(VMVDevice.device(), 1, &mappedRange);
     }
@@ -47,7 +47,7 @@ namespace vmv
         VMVDevice& VMVDevice;
         void* mapped = nullptr;
         VkBuffer buffer = VK_NULL_HANDLE;
-        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VMVMemoryAllocator::Allocation memory{};
 
         VkDeviceSize bufferSize;
         uint32_t instanceCount;
@@ -78,3 +78,21 @@ void vmv::VMVCamera::SetViewEuler(glm::vec3 position, glm::vec3 rotationEuler)
     m_ViewMatrix[3][1] = -glm::dot(v, position);
     m_ViewMatrix[3][2] = -glm::dot(w, position);
 }
+
+std::array<glm::vec4, 6> vmv::VMVCamera::GetFrustumPlanes() const
+{
+    // Gribb-Hartmann extraction, glm is column major so row i is {m[0][i], m[1][i], m[2][i], m[3][i]}
+    const glm::mat4 viewProjection{m_ProjectionMatrix * m_ViewMatrix};
+    const auto row{[&viewProjection](int i) {
+        return glm::vec4{viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]};
+    }};
+
+    // Depth is [0, 1] (GLM_FORCE_DEPTH_ZERO_TO_ONE) so the near plane is the third row alone
+    std::array<glm::vec4, 6> planes{row(3) + row(0), row(3) - row(0), row(3) + row(1),
+                                    row(3) - row(1), row(2),          row(3) - row(2)};
+    for (glm::vec4& plane : planes)
+    {
+        plane /= glm::length(glm::vec3{plane});
+    }
+    return planes;
+}
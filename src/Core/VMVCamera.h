@@ -5,6 +5,8 @@
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #include <glm/glm.hpp>
 
+#include <array>
+
 namespace vmv
 {
     class VMVCamera final
@@ -19,6 +21,10 @@ namespace vmv
         const glm::mat4& GetProjection() const { return m_ProjectionMatrix; }
         const glm::mat4& GetView() const { return m_ViewMatrix; }
 
+        // Left, right, bottom, top, near, far planes of GetProjection() * GetView() in world space as
+        // (normal, distance) with normalized inward facing normals, a point p is inside if dot(n, p) + d >= 0
+        std::array<glm::vec4, 6> GetFrustumPlanes() const;
+
       private:
         glm::mat4 m_ProjectionMatrix{1.f};
         glm::mat4 m_ViewMatrix{1.f};
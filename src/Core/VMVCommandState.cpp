@@ -0,0 +1,137 @@
+#include "VMVCommandState.h"
+#include "VMVFrameInfo.h"
+
+#include <cassert>
+#include <cstring>
+
+void vmv::VMVCommandState::Reset(VkCommandBuffer commandBuffer)
+{
+    // The counters belong to the frame, not to the command buffer
+    const uint32_t pipelineBinds{m_PipelineBinds};
+    const uint32_t bufferBinds{m_BufferBinds};
+    const uint32_t skippedCommands{m_SkippedCommands};
+
+    *this = VMVCommandState{commandBuffer};
+    m_PipelineBinds = pipelineBinds;
+    m_BufferBinds = bufferBinds;
+    m_SkippedCommands = skippedCommands;
+}
+
+uint32_t vmv::VMVCommandState::GetBindPointIndex(VkPipelineBindPoint bindPoint)
+{
+    return bindPoint == VK_PIPELINE_BIND_POINT_COMPUTE ? 1 : 0;
+}
+
+void vmv::VMVCommandState::BindPipeline(VkPipelineBindPoint bindPoint, VkPipeline pipeline)
+{
+    VkPipeline& boundPipeline{m_Pipelines[GetBindPointIndex(bindPoint)]};
+    if (boundPipeline == pipeline)
+    {
+        ++m_SkippedCommands;
+        return;
+    }
+
+    vkCmdBindPipeline(m_CommandBuffer, bindPoint, pipeline);
+    boundPipeline = pipeline;
+    ++m_PipelineBinds;
+}
+
+void vmv::VMVCommandState::BindVertexBuffer(VkBuffer buffer, VkDeviceSize offset)
+{
+    if (m_VertexBuffer == buffer && m_VertexOffset == offset)
+    {
+        ++m_SkippedCommands;
+        return;
+    }
+
+    vkCmdBindVertexBuffers(m_CommandBuffer, 0, 1, &buffer, &offset);
+    m_VertexBuffer = buffer;
+    m_VertexOffset = offset;
+    ++m_BufferBinds;
+}
+
+void vmv::VMVCommandState::BindIndexBuffer(VkBuffer buffer, VkDeviceSize offset, VkIndexType indexType)
+{
+    if (m_IndexBuffer == buffer && m_IndexOffset == offset && m_IndexType == indexType)
+    {
+        ++m_SkippedCommands;
+        return;
+    }
+
+    vkCmdBindIndexBuffer(m_CommandBuffer, buffer, offset, indexType);
+    m_IndexBuffer = buffer;
+    m_IndexOffset = offset;
+    m_IndexType = indexType;
+    ++m_BufferBinds;
+}
+
+void vmv::VMVCommandState::BindDescriptorSet(VkPipelineBindPoint bindPoint,
+                                             VkPipelineLayout layout,
+                                             uint32_t setIndex,
+                                             VkDescriptorSet descriptorSet)
+{
+    assert(setIndex < MAX_TRACKED_SETS && "Descriptor set index is not tracked!");
+
+    // Same set through the same layout, through a different but compatible layout it is bound again to be safe
+    BoundSet& boundSet{m_DescriptorSets[GetBindPointIndex(bindPoint)][setIndex]};
+    if (boundSet.layout == layout && boundSet.descriptorSet == descriptorSet)
+    {
+        ++m_SkippedCommands;
+        return;
+    }
+
+    vkCmdBindDescriptorSets(m_CommandBuffer, bindPoint, layout, setIndex, 1, &descriptorSet, 0, nullptr);
+
+    // Other sets stay bound only if the layouts are compatible, forget the ones bound through another layout
+    for (BoundSet& otherSet : m_DescriptorSets[GetBindPointIndex(bindPoint)])
+    {
+        if (otherSet.layout != layout)
+        {
+            otherSet = {};
+        }
+    }
+    boundSet = {layout, descriptorSet};
+}
+
+bool vmv::VMVCommandState::IsBound(VkDescriptorSet descriptorSet) const
+{
+    for (const auto& boundSets : m_DescriptorSets)
+    {
+        for (const BoundSet& boundSet : boundSets)
+        {
+            if (boundSet.descriptorSet == descriptorSet)
+                return true;
+        }
+    }
+    return false;
+}
+
+void vmv::VMVCommandState::PushConstants(
+    VkPipelineLayout layout, VkShaderStageFlags stages, uint32_t offset, uint32_t size, const void* pValues)
+{
+    assert(size <= MAX_PUSH_CONSTANT_SIZE && "Push constants are larger than tracked!");
+
+    if (m_PushLayout == layout && m_PushStages == stages && m_PushOffset == offset && m_PushSize == size &&
+        std::memcmp(m_PushValues.data(), pValues, size) == 0)
+    {
+        ++m_SkippedCommands;
+        return;
+    }
+
+    vkCmdPushConstants(m_CommandBuffer, layout, stages, offset, size, pValues);
+    m_PushLayout = layout;
+    m_PushStages = stages;
+    m_PushOffset = offset;
+    m_PushSize = size;
+    std::memcpy(m_PushValues.data(), pValues, size);
+}
+
+void vmv::VMVCommandState::FlushStats(VMVFrameStats& stats)
+{
+    stats.pipelineBinds += m_PipelineBinds;
+    stats.bufferBinds += m_BufferBinds;
+    stats.skippedCommands += m_SkippedCommands;
+    m_PipelineBinds = 0;
+    m_BufferBinds = 0;
+    m_SkippedCommands = 0;
+}
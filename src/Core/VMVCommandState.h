@@ -0,0 +1,77 @@
+#ifndef VMV_VMVCOMMANDSTATE_H
+#define VMV_VMVCOMMANDSTATE_H
+
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace vmv
+{
+    struct VMVFrameStats;
+
+    // Remembers what was bound and pushed in one command buffer and drops the commands that would set the same
+    // state again. Only sees what goes through it, so everything recorded into the command buffer that changes
+    // this state has to, or Reset has to be called afterwards. Secondary command buffers and the primary after
+    // executing them start from nothing, so Reset when switching to one.
+    class VMVCommandState final
+    {
+      public:
+        explicit VMVCommandState(VkCommandBuffer commandBuffer = VK_NULL_HANDLE) : m_CommandBuffer{commandBuffer} {}
+
+        void Reset(VkCommandBuffer commandBuffer);
+        VkCommandBuffer GetCommandBuffer() const { return m_CommandBuffer; }
+
+        void BindPipeline(VkPipelineBindPoint bindPoint, VkPipeline pipeline);
+        void BindVertexBuffer(VkBuffer buffer, VkDeviceSize offset);
+        void BindIndexBuffer(VkBuffer buffer, VkDeviceSize offset, VkIndexType indexType);
+        void BindDescriptorSet(VkPipelineBindPoint bindPoint,
+                               VkPipelineLayout layout,
+                               uint32_t setIndex,
+                               VkDescriptorSet descriptorSet);
+        void PushConstants(
+            VkPipelineLayout layout, VkShaderStageFlags stages, uint32_t offset, uint32_t size, const void* pValues);
+
+        // Whether the set is bound at any bind point, a set must not be updated after this command buffer bound it
+        bool IsBound(VkDescriptorSet descriptorSet) const;
+
+        // Adds the commands recorded and skipped since the last call to stats
+        void FlushStats(VMVFrameStats& stats);
+
+      private:
+        static constexpr uint32_t BIND_POINT_COUNT{2}; // graphics and compute
+        static constexpr uint32_t MAX_TRACKED_SETS{4};
+        static constexpr uint32_t MAX_PUSH_CONSTANT_SIZE{128}; // the minimum every device supports
+
+        struct BoundSet
+        {
+            VkPipelineLayout layout{VK_NULL_HANDLE};
+            VkDescriptorSet descriptorSet{VK_NULL_HANDLE};
+        };
+
+        VkCommandBuffer m_CommandBuffer;
+
+        std::array<VkPipeline, BIND_POINT_COUNT> m_Pipelines{};
+        std::array<std::array<BoundSet, MAX_TRACKED_SETS>, BIND_POINT_COUNT> m_DescriptorSets{};
+        VkBuffer m_VertexBuffer{VK_NULL_HANDLE};
+        VkDeviceSize m_VertexOffset{};
+        VkBuffer m_IndexBuffer{VK_NULL_HANDLE};
+        VkDeviceSize m_IndexOffset{};
+        VkIndexType m_IndexType{VK_INDEX_TYPE_UINT32};
+
+        VkPipelineLayout m_PushLayout{VK_NULL_HANDLE};
+        VkShaderStageFlags m_PushStages{};
+        uint32_t m_PushOffset{};
+        uint32_t m_PushSize{};
+        std::array<std::byte, MAX_PUSH_CONSTANT_SIZE> m_PushValues{};
+
+        uint32_t m_PipelineBinds{};
+        uint32_t m_BufferBinds{};
+        uint32_t m_SkippedCommands{};
+
+        static uint32_t GetBindPointIndex(VkPipelineBindPoint bindPoint);
+    };
+} // namespace vmv
+
+#endif
\ No newline at end of file
@@ -1,5 +1,10 @@
 #include "VMVDevice.h"
 
+#include "VMVGeometryPool.h"
+#include "VMVPipelineCache.h"
+#include "VMVPipelineLibrary.h"
+#include "VMVStagingRing.h"
+
 // std headers
 #include <cstring>
 #include <iostream>
@@ -59,11 +64,25 @@ namespace vmv
         pickPhysicalDevice();
         createLogicalDevice();
         createCommandPool();
+        memoryAllocator = std::make_unique<VMVMemoryAllocator>(device_, physicalDevice);
+        stagingRing = std::make_unique<VMVStagingRing>(*this, STAGING_RING_SIZE);
+        geometryPool = std::make_unique<VMVGeometryPool>(*this);
+        pipelineCache = std::make_unique<VMVPipelineCache>(device_, properties);
+        pipelineLibrary = std::make_unique<VMVPipelineLibrary>(*this);
     }
 
     VMVDevice::~VMVDevice()
     {
+        pipelineLibrary.reset(); // finishes the compiles using the cache
+        pipelineCache.reset();   // saves the cache, needs the device
+        geometryPool.reset();
+        stagingRing.reset();
+        memoryAllocator.reset();
         vkDestroyCommandPool(device_, commandPool, nullptr);
+        if (transferCommandPool != commandPool)
+        {
+            vkDestroyCommandPool(device_, transferCommandPool, nullptr);
+        }
         vkDestroyDevice(device_, nullptr);
 
         if (enableValidationLayers)
@@ -155,6 +174,10 @@ namespace vmv
 
         std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
         std::set<uint32_t> uniqueQueueFamilies = {indices.graphicsFamily, indices.presentFamily};
+        if (indices.transferFamilyHasValue)
+        {
+            uniqueQueueFamilies.insert(indices.transferFamily);
+        }
 
         float queuePriority = 1.0f;
         for (uint32_t queueFamily : uniqueQueueFamilies)
@@ -167,8 +190,20 @@ namespace vmv
             queueCreateInfos.push_back(queueCreateInfo);
         }
 
+        VkPhysicalDeviceFeatures supportedFeatures;
+        vkGetPhysicalDeviceFeatures(physicalDevice, &supportedFeatures);
+
         VkPhysicalDeviceFeatures deviceFeatures = {};
         deviceFeatures.samplerAnisotropy = VK_TRUE;
+        deviceFeatures.multiDrawIndirect = supportedFeatures.multiDrawIndirect;
+        deviceFeatures.drawIndirectFirstInstance = supportedFeatures.drawIndirectFirstInstance;
+
+        std::vector<const char*> enabledExtensions(deviceExtensions.begin(), deviceExtensions.end());
+        const bool hasDrawIndirectCount = isDeviceExtensionSupported(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+        if (hasDrawIndirectCount)
+        {
+            enabledExtensions.push_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+        }
 
         VkDeviceCreateInfo createInfo = {};
         createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
@@ -177,8 +212,8 @@ namespace vmv
         createInfo.pQueueCreateInfos = queueCreateInfos.data();
 
         createInfo.pEnabledFeatures = &deviceFeatures;
-        createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-        createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+        createInfo.enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size());
+        createInfo.ppEnabledExtensionNames = enabledExtensions.data();
 
         // might not really be necessary anymore because device specific validation layers
         // have been deprecated
@@ -197,8 +232,23 @@ namespace vmv
             throw std::runtime_error("failed to create logical device!");
         }
 
+        enabledFeatures = deviceFeatures;
+        if (hasDrawIndirectCount)
+        {
+            cmdDrawIndexedIndirectCount = reinterpret_cast<PFN_vkCmdDrawIndexedIndirectCountKHR>(
+                vkGetDeviceProcAddr(device_, "vkCmdDrawIndexedIndirectCountKHR"));
+        }
+
         vkGetDeviceQueue(device_, indices.graphicsFamily, 0, &graphicsQueue_);
         vkGetDeviceQueue(device_, indices.presentFamily, 0, &presentQueue_);
+
+        transferQueue_ = graphicsQueue_;
+        bufferQueueFamilies = {indices.graphicsFamily};
+        if (indices.transferFamilyHasValue)
+        {
+            vkGetDeviceQueue(device_, indices.transferFamily, 0, &transferQueue_);
+            bufferQueueFamilies.push_back(indices.transferFamily);
+        }
     }
 
     void VMVDevice::createCommandPool()
@@ -214,6 +264,16 @@ namespace vmv
         {
             throw std::runtime_error("failed to create command pool!");
         }
+
+        transferCommandPool = commandPool;
+        if (queueFamilyIndices.transferFamilyHasValue)
+        {
+            poolInfo.queueFamilyIndex = queueFamilyIndices.transferFamily;
+            if (vkCreateCommandPool(device_, &poolInfo, nullptr, &transferCommandPool) != VK_SUCCESS)
+            {
+                throw std::runtime_error("failed to create transfer command pool!");
+            }
+        }
     }
 
     void VMVDevice::createSurface()
@@ -352,6 +412,24 @@ namespace vmv
         return requiredExtensions.empty();
     }
 
+    bool VMVDevice::isDeviceExtensionSupported(const char* extensionName)
+    {
+        uint32_t extensionCount;
+        vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, nullptr);
+
+        std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+        vkEnumerateDeviceExtensionProperties(physicalDevice, nullptr, &extensionCount, availableExtensions.data());
+
+        for (const auto& extension : availableExtensions)
+        {
+            if (strcmp(extension.extensionName, extensionName) == 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
     QueueFamilyIndices VMVDevice::findQueueFamilies(VkPhysicalDevice device)
     {
         QueueFamilyIndices indices;
@@ -365,21 +443,26 @@ namespace vmv
         int i = 0;
         for (const auto& queueFamily : queueFamilies)
         {
-            if (queueFamily.queueCount > 0 && queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT)
+            if (!indices.graphicsFamilyHasValue && queueFamily.queueCount > 0 &&
+                queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT)
             {
                 indices.graphicsFamily = i;
                 indices.graphicsFamilyHasValue = true;
             }
             VkBool32 presentSupport = false;
             vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface_, &presentSupport);
-            if (queueFamily.queueCount > 0 && presentSupport)
+            if (!indices.presentFamilyHasValue && queueFamily.queueCount > 0 && presentSupport)
             {
                 indices.presentFamily = i;
                 indices.presentFamilyHasValue = true;
             }
-            if (indices.isComplete())
+            // Transfer-only families map to the copy engines and run uploads alongside rendering
+            if (!indices.transferFamilyHasValue && queueFamily.queueCount > 0 &&
+                queueFamily.queueFlags & VK_QUEUE_TRANSFER_BIT &&
+                !(queueFamily.queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)))
             {
-                break;
+                indices.transferFamily = i;
+                indices.transferFamilyHasValue = true;
             }
 
             i++;
@@ -453,7 +536,7 @@ namespace vmv
                                  VkBufferUsageFlags usage,
                                  VkMemoryPropertyFlags properties,
                                  VkBuffer& buffer,
-                                 VkDeviceMemory& bufferMemory)
+                                 VMVMemoryAllocator::Allocation& bufferMemory)
     {
         VkBufferCreateInfo bufferInfo{};
         bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -461,6 +544,14 @@ namespace vmv
         bufferInfo.usage = usage;
         bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
+        // Upload destinations are written on the transfer queue and read on the graphics queue
+        if ((usage & VK_BUFFER_USAGE_TRANSFER_DST_BIT) && bufferQueueFamilies.size() > 1)
+        {
+            bufferInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+            bufferInfo.queueFamilyIndexCount = static_cast<uint32_t>(bufferQueueFamilies.size());
+            bufferInfo.pQueueFamilyIndices = bufferQueueFamilies.data();
+        }
+
         if (vkCreateBuffer(device_, &bufferInfo, nullptr, &buffer) != VK_SUCCESS)
         {
             throw std::runtime_error("failed to create vertex buffer!");
@@ -469,17 +560,8 @@ namespace vmv
         VkMemoryRequirements memRequirements;
         vkGetBufferMemoryRequirements(device_, buffer, &memRequirements);
 
-        VkMemoryAllocateInfo allocInfo{};
-        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        allocInfo.allocationSize = memRequirements.size;
-        allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
-
-        if (vkAllocateMemory(device_, &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS)
-        {
-            throw std::runtime_error("failed to allocate vertex buffer memory!");
-        }
-
-        vkBindBufferMemory(device_, buffer, bufferMemory, 0);
+        bufferMemory = memoryAllocator->Allocate(memRequirements, properties, true);
+        vkBindBufferMemory(device_, buffer, bufferMemory.memory, bufferMemory.offset);
     }
 
     VkCommandBuffer VMVDevice::beginSingleTimeCommands()
@@ -554,7 +636,7 @@ namespace vmv
     void VMVDevice::createImageWithInfo(const VkImageCreateInfo& imageInfo,
                                         VkMemoryPropertyFlags properties,
                                         VkImage& image,
-                                        VkDeviceMemory& imageMemory)
+                                        VMVMemoryAllocator::Allocation& imageMemory)
     {
         if (vkCreateImage(device_, &imageInfo, nullptr, &image) != VK_SUCCESS)
         {
@@ -564,17 +646,10 @@ namespace vmv
         VkMemoryRequirements memRequirements;
         vkGetImageMemoryRequirements(device_, image, &memRequirements);
 
-        VkMemoryAllocateInfo allocInfo{};
-        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        allocInfo.allocationSize = memRequirements.size;
-        allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
-
-        if (vkAllocateMemory(device_, &allocInfo, nullptr, &imageMemory) != VK_SUCCESS)
-        {
-            throw std::runtime_error("failed to allocate image memory!");
-        }
+        imageMemory = memoryAllocator->Allocate(
+            memRequirements, properties, imageInfo.tiling == VK_IMAGE_TILING_LINEAR);
 
-        if (vkBindImageMemory(device_, image, imageMemory, 0) != VK_SUCCESS)
+        if (vkBindImageMemory(device_, image, imageMemory.memory, imageMemory.offset) != VK_SUCCESS)
         {
             throw std::runtime_error("failed to bind image memory!");
         }
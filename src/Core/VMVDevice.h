@@ -1,14 +1,20 @@
 #ifndef VMV_VMVDEVICE_H
 #define VMV_VMVDEVICE_H
 
+#include "VMVMemoryAllocator.h"
 #include "VMVWindow.h"
 
 // std lib headers
+#include <memory>
 #include <string>
 #include <vector>
 
 namespace vmv
 {
+    class VMVGeometryPool;
+    class VMVPipelineCache;
+    class VMVPipelineLibrary;
+    class VMVStagingRing;
 
     struct SwapChainSupportDetails
     {
@@ -21,8 +27,10 @@ namespace vmv
     {
         uint32_t graphicsFamily;
         uint32_t presentFamily;
+        uint32_t transferFamily;
         bool graphicsFamilyHasValue = false;
         bool presentFamilyHasValue = false;
+        bool transferFamilyHasValue = false; // only set for a transfer-only family
         bool isComplete()
         {
             return graphicsFamilyHasValue && presentFamilyHasValue;
@@ -38,6 +46,8 @@ namespace vmv
         const bool enableValidationLayers = true;
 #endif
 
+        static constexpr VkDeviceSize STAGING_RING_SIZE = 32 * 1024 * 1024;
+
         VMVDevice(VMVWindow& window);
         ~VMVDevice();
 
@@ -67,6 +77,56 @@ namespace vmv
         {
             return presentQueue_;
         }
+        // Falls back to the graphics queue when the device has no dedicated transfer family
+        VkQueue transferQueue()
+        {
+            return transferQueue_;
+        }
+        VkCommandPool getTransferCommandPool()
+        {
+            return transferCommandPool;
+        }
+        bool hasDedicatedTransferQueue()
+        {
+            return transferQueue_ != graphicsQueue_;
+        }
+        VMVStagingRing& getStagingRing()
+        {
+            return *stagingRing;
+        }
+        VMVMemoryAllocator& getMemoryAllocator()
+        {
+            return *memoryAllocator;
+        }
+        VMVGeometryPool& getGeometryPool()
+        {
+            return *geometryPool;
+        }
+        // Every pipeline is created through it, persisted across runs
+        VMVPipelineCache& getPipelineCache()
+        {
+            return *pipelineCache;
+        }
+        // Compiles graphics pipelines in the background
+        VMVPipelineLibrary& getPipelineLibrary()
+        {
+            return *pipelineLibrary;
+        }
+
+        // Optional features, enabled at device creation when the physical device has them
+        bool supportsMultiDrawIndirect()
+        {
+            return enabledFeatures.multiDrawIndirect == VK_TRUE;
+        }
+        bool supportsDrawIndirectFirstInstance()
+        {
+            return enabledFeatures.drawIndirectFirstInstance == VK_TRUE;
+        }
+        // nullptr without VK_KHR_draw_indirect_count
+        PFN_vkCmdDrawIndexedIndirectCountKHR getCmdDrawIndexedIndirectCount()
+        {
+            return cmdDrawIndexedIndirectCount;
+        }
 
         SwapChainSupportDetails getSwapChainSupport()
         {
@@ -86,7 +146,7 @@ namespace vmv
                           VkBufferUsageFlags usage,
                           VkMemoryPropertyFlags properties,
                           VkBuffer& buffer,
-                          VkDeviceMemory& bufferMemory);
+                          VMVMemoryAllocator::Allocation& bufferMemory);
         VkCommandBuffer beginSingleTimeCommands();
         void endSingleTimeCommands(VkCommandBuffer commandBuffer);
         void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
@@ -95,7 +155,7 @@ namespace vmv
         void createImageWithInfo(const VkImageCreateInfo& imageInfo,
                                  VkMemoryPropertyFlags properties,
                                  VkImage& image,
-                                 VkDeviceMemory& imageMemory);
+                                 VMVMemoryAllocator::Allocation& imageMemory);
 
         VkPhysicalDeviceProperties properties;
 
@@ -115,18 +175,30 @@ namespace vmv
         void populateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT& createInfo);
         void hasGflwRequiredInstanceExtensions();
         bool checkDeviceExtensionSupport(VkPhysicalDevice device);
+        bool isDeviceExtensionSupported(const char* extensionName);
         SwapChainSupportDetails querySwapChainSupport(VkPhysicalDevice device);
 
         VkInstance instance;
         VkDebugUtilsMessengerEXT debugMessenger;
         VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
         VMVWindow& window;
-        VkCommandPool commandPool;
+        VkCommandPool commandPool; // single time commands only, frames record from the renderer's own pools
+        VkCommandPool transferCommandPool;
+        std::vector<uint32_t> bufferQueueFamilies;
+        std::unique_ptr<VMVMemoryAllocator> memoryAllocator;
+        std::unique_ptr<VMVStagingRing> stagingRing;
+        std::unique_ptr<VMVGeometryPool> geometryPool;
+        std::unique_ptr<VMVPipelineCache> pipelineCache;
+        std::unique_ptr<VMVPipelineLibrary> pipelineLibrary;
+
+        VkPhysicalDeviceFeatures enabledFeatures = {};
+        PFN_vkCmdDrawIndexedIndirectCountKHR cmdDrawIndexedIndirectCount = nullptr;
 
         VkDevice device_;
         VkSurfaceKHR surface_;
         VkQueue graphicsQueue_;
         VkQueue presentQueue_;
+        VkQueue transferQueue_;
 
         const std::vector<const char*> validationLayers = {"VK_LAYER_KHRONOS_validation"};
         const std::vector<const char*> deviceExtensions = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
@@ -0,0 +1,136 @@
+#include "VMVDrawSorter.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <span>
+#include <utility>
+
+uint64_t vmv::VMVDrawSorter::MakeKey(uint32_t pipeline, uint32_t buffers, VMVScene::ModelId modelId, float depth)
+{
+    assert(pipeline < (1u << PIPELINE_BITS) && buffers < (1u << BUFFER_BITS) && modelId < (1u << MODEL_BITS) &&
+           "Draw state does not fit into the key!");
+
+    return static_cast<uint64_t>(pipeline) << (BUFFER_BITS + MODEL_BITS + DEPTH_BITS) |
+           static_cast<uint64_t>(buffers) << (MODEL_BITS + DEPTH_BITS) |
+           static_cast<uint64_t>(modelId) << DEPTH_BITS | GetDepthBits(depth);
+}
+
+uint32_t vmv::VMVDrawSorter::GetDepthBits(float depth)
+{
+    // The bits of a positive float grow with its value, the top ones are enough to sort by. Behind the camera
+    // counts as closest.
+    return depth > 0.f ? std::bit_cast<uint32_t>(depth) >> (32 - DEPTH_BITS) : 0;
+}
+
+void vmv::VMVDrawSorter::Sort(const VMVScene& scene, std::vector<uint32_t>& entities, const VMVCamera* pCamera)
+{
+    if (entities.size() < 2)
+        return;
+
+    UpdateModelKeys(scene);
+
+    const std::span<const Transform> transforms{scene.GetTransforms()};
+    const std::span<const VMVScene::ModelId> modelIds{scene.GetModelIds()};
+    m_Keys.resize(entities.size());
+    if (pCamera == nullptr)
+    {
+        for (size_t i{}; i < entities.size(); ++i)
+        {
+            m_Keys[i] = m_ModelKeys[modelIds[entities[i]]];
+        }
+    }
+    else
+    {
+        // View space z of the entity's origin
+        const glm::mat4& view{pCamera->GetView()};
+        const glm::vec4 depthRow{view[0][2], view[1][2], view[2][2], view[3][2]};
+        for (size_t i{}; i < entities.size(); ++i)
+        {
+            const float depth{glm::dot(depthRow, glm::vec4{transforms[entities[i]].GetTranslation(), 1.f})};
+            m_Keys[i] = m_ModelKeys[modelIds[entities[i]]] | GetDepthBits(depth);
+        }
+    }
+
+    RadixSort(entities);
+}
+
+void vmv::VMVDrawSorter::UpdateModelKeys(const VMVScene& scene)
+{
+    // A handful of models, so the linear search for a buffer set is cheaper than anything smarter
+    m_ModelKeys.resize(scene.GetModelCount());
+    m_BufferModels.clear();
+    for (VMVScene::ModelId modelId{}; modelId < scene.GetModelCount(); ++modelId)
+    {
+        const VMVModel& model{scene.GetModel(modelId)};
+        uint32_t buffers{};
+        for (; buffers < m_BufferModels.size(); ++buffers)
+        {
+            const VMVModel& other{*m_BufferModels[buffers]};
+            if (model.SharesBuffersWith(other) && other.SharesBuffersWith(model))
+                break;
+        }
+        if (buffers == m_BufferModels.size())
+        {
+            m_BufferModels.push_back(&model);
+        }
+
+        m_ModelKeys[modelId] = MakeKey(static_cast<uint32_t>(model.GetVertexFormat()), buffers, modelId, 0.f);
+    }
+}
+
+void vmv::VMVDrawSorter::RadixSort(std::vector<uint32_t>& entities)
+{
+    constexpr uint32_t DIGIT_BITS{8};
+    constexpr uint32_t BUCKET_COUNT{1 << DIGIT_BITS};
+    constexpr uint32_t PASS_COUNT{64 / DIGIT_BITS};
+
+    // All histograms in one read of the keys
+    std::array<std::array<uint32_t, BUCKET_COUNT>, PASS_COUNT> histograms{};
+    for (uint64_t key : m_Keys)
+    {
+        for (uint32_t pass{}; pass < PASS_COUNT; ++pass)
+        {
+            ++histograms[pass][(key >> (pass * DIGIT_BITS)) & (BUCKET_COUNT - 1)];
+        }
+    }
+
+    const size_t count{entities.size()};
+    m_ScratchKeys.resize(count);
+    m_ScratchEntities.resize(count);
+
+    uint64_t* pKeys{m_Keys.data()};
+    uint32_t* pEntities{entities.data()};
+    uint64_t* pOutKeys{m_ScratchKeys.data()};
+    uint32_t* pOutEntities{m_ScratchEntities.data()};
+    for (uint32_t pass{}; pass < PASS_COUNT; ++pass)
+    {
+        const uint32_t shift{pass * DIGIT_BITS};
+        std::array<uint32_t, BUCKET_COUNT>& histogram{histograms[pass]};
+        if (histogram[(pKeys[0] >> shift) & (BUCKET_COUNT - 1)] == count)
+            continue; // every key has the same digit, the pass would not move anything
+
+        uint32_t offset{};
+        for (uint32_t& bucket : histogram)
+        {
+            const uint32_t bucketCount{bucket};
+            bucket = offset;
+            offset += bucketCount;
+        }
+
+        for (size_t i{}; i < count; ++i)
+        {
+            const uint32_t index{histogram[(pKeys[i] >> shift) & (BUCKET_COUNT - 1)]++};
+            pOutKeys[index] = pKeys[i];
+            pOutEntities[index] = pEntities[i];
+        }
+        std::swap(pKeys, pOutKeys);
+        std::swap(pEntities, pOutEntities);
+    }
+
+    if (pEntities != entities.data())
+    {
+        std::copy(pEntities, pEntities + count, entities.data());
+    }
+}
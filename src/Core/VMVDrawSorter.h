@@ -0,0 +1,46 @@
+#ifndef VMV_VMVDRAWSORTER_H
+#define VMV_VMVDRAWSORTER_H
+
+#include "VMVCamera.h"
+#include "VMVScene.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace vmv
+{
+    // Orders draws by 64 bit keys so draws sharing a pipeline and vertex/index buffers end up next to each other,
+    // front to back within a model. The keys are sorted with an LSD radix sort, 8 bits per pass, and passes
+    // where every key has the same digit are skipped.
+    class VMVDrawSorter final
+    {
+      public:
+        // From the most significant bits down. The render systems pick their pipeline by vertex format, so the
+        // format stands in for the pipeline. Buffers are a per frame index of the distinct buffer sets.
+        static constexpr uint32_t PIPELINE_BITS{8};
+        static constexpr uint32_t BUFFER_BITS{12};
+        static constexpr uint32_t MODEL_BITS{20};
+        static constexpr uint32_t DEPTH_BITS{24};
+
+        static uint64_t MakeKey(uint32_t pipeline, uint32_t buffers, VMVScene::ModelId modelId, float depth);
+
+        // Sorts the dense entity indices by their key. Without a camera the depth is left out and entities with
+        // the same state keep their order.
+        void Sort(const VMVScene& scene, std::vector<uint32_t>& entities, const VMVCamera* pCamera);
+
+      private:
+        std::vector<uint64_t> m_ModelKeys{}; // the state bits of every model id
+        std::vector<const VMVModel*> m_BufferModels{}; // one model per distinct buffer set
+
+        // Kept to avoid allocating every frame
+        std::vector<uint64_t> m_Keys{};
+        std::vector<uint64_t> m_ScratchKeys{};
+        std::vector<uint32_t> m_ScratchEntities{};
+
+        static uint32_t GetDepthBits(float depth);
+        void UpdateModelKeys(const VMVScene& scene);
+        void RadixSort(std::vector<uint32_t>& entities);
+    };
+} // namespace vmv
+
+#endif
\ No newline at end of file
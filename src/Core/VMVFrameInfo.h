@@ -2,16 +2,33 @@
 #define VMV_VMVFRAMEINFO_H
 
 #include "VMVCamera.h"
+#include "VMVCommandState.h"
 #include <vulkan/vulkan.h>
 
 namespace vmv
 {
+    // Counters the render systems fill in while recording a frame
+    struct VMVFrameStats
+    {
+        uint32_t drawCalls{};    // vkCmdDraw* calls recorded
+        uint32_t drawCommands{}; // draws executed, including each command of a multi-draw
+        uint32_t instances{};
+        uint32_t pipelineBinds{};
+        uint32_t bufferBinds{};     // vertex and index buffer binds
+        uint32_t skippedCommands{}; // binds and push constants VMVCommandState found redundant
+        uint32_t visibleObjects{}; // GPU culled counts trail by the frames in flight
+        uint32_t culledObjects{};
+        float recordTime{};      // CPU time spent recording draws, in ms
+    };
+
     struct VMVFrameInfo
     {
         int frameIndex;
         float frameTime;
         VkCommandBuffer commandBuffer;
         VMVCamera& camera;
+        VMVFrameStats stats{};
+        VMVCommandState commandState{commandBuffer}; // reset it when recording into another command buffer
     };
 } // namespace vmv
 
@@ -0,0 +1,45 @@
+#include "VMVFramePacer.h"
+
+#include <thread>
+
+vmv::VMVFramePacer::VMVFramePacer(VMVRenderer& renderer) : m_VMVRenderer{renderer} {}
+
+void vmv::VMVFramePacer::SetFrameRateLimit(float framesPerSecond)
+{
+    m_FrameRateLimit = framesPerSecond > 0.f ? framesPerSecond : 0.f;
+    m_FrameInterval = m_FrameRateLimit > 0.f ? std::chrono::duration_cast<Clock::duration>(
+                                                   std::chrono::duration<float>{1.f / m_FrameRateLimit})
+                                             : Clock::duration::zero();
+    m_NextFrameTime = Clock::now();
+}
+
+void vmv::VMVFramePacer::WaitForNextFrame()
+{
+    const Clock::time_point start{Clock::now()};
+
+    if (m_FrameInterval > Clock::duration::zero())
+    {
+        if (m_NextFrameTime - start > SPIN_DURATION)
+        {
+            std::this_thread::sleep_until(m_NextFrameTime - SPIN_DURATION);
+        }
+        while (Clock::now() < m_NextFrameTime)
+        {
+            std::this_thread::yield();
+        }
+
+        // A frame that ran more than an interval late restarts the schedule instead of rushing to catch up
+        const Clock::time_point now{Clock::now()};
+        m_NextFrameTime = (now - m_NextFrameTime > m_FrameInterval ? now : m_NextFrameTime) + m_FrameInterval;
+    }
+
+    m_VMVRenderer.WaitForNextFrame();
+
+    m_InputTime = Clock::now();
+    m_WaitTime = std::chrono::duration<float, std::milli>(m_InputTime - start).count();
+}
+
+void vmv::VMVFramePacer::OnFrameSubmitted()
+{
+    m_InputLatency = std::chrono::duration<float, std::milli>(Clock::now() - m_InputTime).count();
+}
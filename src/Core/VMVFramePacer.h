@@ -0,0 +1,54 @@
+#ifndef VMV_VMVFRAMEPACER_H
+#define VMV_VMVFRAMEPACER_H
+
+#include "VMVRenderer.h"
+#include <chrono>
+
+namespace vmv
+{
+    // Moves the wait for a free frame in flight in front of input sampling, so input is read right before the
+    // frame gets recorded instead of a frame or two earlier, and optionally caps the frame rate
+    class VMVFramePacer final
+    {
+      public:
+        explicit VMVFramePacer(VMVRenderer& renderer);
+
+        VMVFramePacer(const VMVFramePacer&) = delete;
+        VMVFramePacer(VMVFramePacer&&) noexcept = delete;
+        VMVFramePacer& operator=(const VMVFramePacer&) = delete;
+        VMVFramePacer& operator=(VMVFramePacer&&) noexcept = delete;
+
+        // 0 disables the cap
+        void SetFrameRateLimit(float framesPerSecond);
+        float GetFrameRateLimit() const { return m_FrameRateLimit; }
+
+        // Sleeps until the frame rate limit allows the next frame, then waits for its frame in flight to be free.
+        // Poll input right after this returns.
+        void WaitForNextFrame();
+        // Call after VMVRenderer::EndFrame submitted the frame
+        void OnFrameSubmitted();
+
+        // Time from WaitForNextFrame returning to the last submit, in ms
+        float GetInputLatency() const { return m_InputLatency; }
+        // Time the last WaitForNextFrame spent sleeping and waiting for the GPU, in ms
+        float GetWaitTime() const { return m_WaitTime; }
+
+      private:
+        using Clock = std::chrono::steady_clock;
+
+        // Sleeps can overshoot by about a scheduler tick, so the last stretch before a deadline is spun instead
+        static constexpr Clock::duration SPIN_DURATION{std::chrono::milliseconds{2}};
+
+        VMVRenderer& m_VMVRenderer;
+
+        float m_FrameRateLimit{};
+        Clock::duration m_FrameInterval{};
+        Clock::time_point m_NextFrameTime{};
+        Clock::time_point m_InputTime{};
+
+        float m_InputLatency{};
+        float m_WaitTime{};
+    };
+} // namespace vmv
+
+#endif
\ No newline at end of file
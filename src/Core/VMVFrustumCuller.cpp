@@ -0,0 +1,280 @@
+#include "VMVFrustumCuller.h"
+#include "VMVCamera.h"
+#include "VMVSimd.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <random>
+
+void vmv::VMVFrustumCuller::Resize(size_t count)
+{
+    m_Count = count;
+
+    const size_t paddedCount{(count + LANE_COUNT - 1) / LANE_COUNT * LANE_COUNT};
+    m_CentersX.resize(paddedCount);
+    m_CentersY.resize(paddedCount);
+    m_CentersZ.resize(paddedCount);
+    m_Radii.resize(paddedCount);
+
+    // A huge negative radius puts the padding outside of every plane
+    for (size_t i{count}; i < paddedCount; ++i)
+    {
+        m_CentersX[i] = 0.f;
+        m_CentersY[i] = 0.f;
+        m_CentersZ[i] = 0.f;
+        m_Radii[i] = -std::numeric_limits<float>::max();
+    }
+}
+
+void vmv::VMVFrustumCuller::SetSphere(size_t index, const glm::vec3& center, float radius)
+{
+    assert(index < m_Count && "Sphere index out of range!");
+    m_CentersX[index] = center.x;
+    m_CentersY[index] = center.y;
+    m_CentersZ[index] = center.z;
+    m_Radii[index] = radius;
+}
+
+uint32_t vmv::VMVFrustumCuller::Cull(const std::array<glm::vec4, 6>& planes, std::vector<uint32_t>& outVisible) const
+{
+    static const Implementation bestImplementation{GetBestImplementation()};
+    return Cull(planes, outVisible, bestImplementation);
+}
+
+uint32_t vmv::VMVFrustumCuller::Cull(const std::array<glm::vec4, 6>& planes,
+                                     std::vector<uint32_t>& outVisible,
+                                     Implementation implementation) const
+{
+    // Sized for the worst case so the loops can store without checking, trimmed afterwards
+    outVisible.resize(m_CentersX.size());
+
+    uint32_t visibleCount{};
+    switch (IsSupported(implementation) ? implementation : Implementation::Scalar)
+    {
+    case Implementation::Scalar:
+        visibleCount = CullScalar(planes, outVisible.data());
+        break;
+    case Implementation::Sse:
+        visibleCount = CullSse(planes, outVisible.data());
+        break;
+    case Implementation::Avx:
+        visibleCount = CullAvx(planes, outVisible.data());
+        break;
+    }
+
+    outVisible.resize(visibleCount);
+    return visibleCount;
+}
+
+vmv::VMVFrustumCuller::Implementation vmv::VMVFrustumCuller::GetBestImplementation()
+{
+    if (IsSupported(Implementation::Avx))
+        return Implementation::Avx;
+    if (IsSupported(Implementation::Sse))
+        return Implementation::Sse;
+    return Implementation::Scalar;
+}
+
+bool vmv::VMVFrustumCuller::IsSupported(Implementation implementation)
+{
+    switch (implementation)
+    {
+    case Implementation::Scalar:
+        return true;
+#if defined(VMV_X86_SIMD)
+    case Implementation::Sse: // part of x86-64
+        return true;
+    case Implementation::Avx:
+        return isAvxSupported();
+#endif
+    default:
+        return false;
+    }
+}
+
+const char* vmv::VMVFrustumCuller::GetImplementationName(Implementation implementation)
+{
+    switch (implementation)
+    {
+    case Implementation::Scalar:
+        return "scalar";
+    case Implementation::Sse:
+        return "SSE";
+    case Implementation::Avx:
+        return "AVX";
+    }
+    return "unknown";
+}
+
+uint32_t vmv::VMVFrustumCuller::CullScalar(const std::array<glm::vec4, 6>& planes, uint32_t* pVisible) const
+{
+    uint32_t visibleCount{};
+    for (size_t i{}; i < m_Count; ++i)
+    {
+        bool isVisible{true};
+        for (const glm::vec4& plane : planes)
+        {
+            const float distance{plane.x * m_CentersX[i] + plane.y * m_CentersY[i] + plane.z * m_CentersZ[i] +
+                                 plane.w};
+            if (distance < -m_Radii[i])
+            {
+                isVisible = false;
+                break;
+            }
+        }
+
+        if (isVisible)
+        {
+            pVisible[visibleCount++] = static_cast<uint32_t>(i);
+        }
+    }
+    return visibleCount;
+}
+
+uint32_t vmv::VMVFrustumCuller::CullSse(const std::array<glm::vec4, 6>& planes, uint32_t* pVisible) const
+{
+#if defined(VMV_X86_SIMD)
+    __m128 planesX[6]{};
+    __m128 planesY[6]{};
+    __m128 planesZ[6]{};
+    __m128 planesW[6]{};
+    for (size_t p{}; p < planes.size(); ++p)
+    {
+        planesX[p] = _mm_set1_ps(planes[p].x);
+        planesY[p] = _mm_set1_ps(planes[p].y);
+        planesZ[p] = _mm_set1_ps(planes[p].z);
+        planesW[p] = _mm_set1_ps(planes[p].w);
+    }
+
+    const __m128 zero{_mm_setzero_ps()};
+    uint32_t visibleCount{};
+    for (size_t i{}; i < m_Count; i += 4)
+    {
+        const __m128 centersX{_mm_loadu_ps(m_CentersX.data() + i)};
+        const __m128 centersY{_mm_loadu_ps(m_CentersY.data() + i)};
+        const __m128 centersZ{_mm_loadu_ps(m_CentersZ.data() + i)};
+        const __m128 radii{_mm_loadu_ps(m_Radii.data() + i)};
+
+        // distance + radius >= 0 for every plane
+        __m128 isVisible{_mm_castsi128_ps(_mm_set1_epi32(-1))};
+        for (size_t p{}; p < planes.size(); ++p)
+        {
+            __m128 distance{_mm_add_ps(_mm_mul_ps(planesX[p], centersX), planesW[p])};
+            distance = _mm_add_ps(distance, _mm_mul_ps(planesY[p], centersY));
+            distance = _mm_add_ps(distance, _mm_mul_ps(planesZ[p], centersZ));
+            isVisible = _mm_and_ps(isVisible, _mm_cmpge_ps(_mm_add_ps(distance, radii), zero));
+        }
+
+        for (uint32_t mask{static_cast<uint32_t>(_mm_movemask_ps(isVisible))}; mask != 0; mask &= mask - 1)
+        {
+            pVisible[visibleCount++] = static_cast<uint32_t>(i) + static_cast<uint32_t>(std::countr_zero(mask));
+        }
+    }
+    return visibleCount;
+#else
+    return CullScalar(planes, pVisible);
+#endif
+}
+
+VMV_TARGET_AVX uint32_t vmv::VMVFrustumCuller::CullAvx(const std::array<glm::vec4, 6>& planes,
+                                                        uint32_t* pVisible) const
+{
+#if defined(VMV_X86_SIMD)
+    __m256 planesX[6]{};
+    __m256 planesY[6]{};
+    __m256 planesZ[6]{};
+    __m256 planesW[6]{};
+    for (size_t p{}; p < planes.size(); ++p)
+    {
+        planesX[p] = _mm256_set1_ps(planes[p].x);
+        planesY[p] = _mm256_set1_ps(planes[p].y);
+        planesZ[p] = _mm256_set1_ps(planes[p].z);
+        planesW[p] = _mm256_set1_ps(planes[p].w);
+    }
+
+    const __m256 zero{_mm256_setzero_ps()};
+    uint32_t visibleCount{};
+    for (size_t i{}; i < m_Count; i += 8)
+    {
+        const __m256 centersX{_mm256_loadu_ps(m_CentersX.data() + i)};
+        const __m256 centersY{_mm256_loadu_ps(m_CentersY.data() + i)};
+        const __m256 centersZ{_mm256_loadu_ps(m_CentersZ.data() + i)};
+        const __m256 radii{_mm256_loadu_ps(m_Radii.data() + i)};
+
+        __m256 isVisible{_mm256_castsi256_ps(_mm256_set1_epi32(-1))};
+        for (size_t p{}; p < planes.size(); ++p)
+        {
+            __m256 distance{_mm256_add_ps(_mm256_mul_ps(planesX[p], centersX), planesW[p])};
+            distance = _mm256_add_ps(distance, _mm256_mul_ps(planesY[p], centersY));
+            distance = _mm256_add_ps(distance, _mm256_mul_ps(planesZ[p], centersZ));
+            isVisible = _mm256_and_ps(isVisible, _mm256_cmp_ps(_mm256_add_ps(distance, radii), zero, _CMP_GE_OQ));
+        }
+
+        for (uint32_t mask{static_cast<uint32_t>(_mm256_movemask_ps(isVisible))}; mask != 0; mask &= mask - 1)
+        {
+            pVisible[visibleCount++] = static_cast<uint32_t>(i) + static_cast<uint32_t>(std::countr_zero(mask));
+        }
+    }
+    return visibleCount;
+#else
+    return CullScalar(planes, pVisible);
+#endif
+}
+
+void vmv::VMVFrustumCuller::RunBenchmark(size_t sphereCount)
+{
+    constexpr uint32_t ITERATIONS{20};
+
+    // Spheres scattered in a cube around a camera looking down +z, roughly 40% end up visible
+    std::mt19937 random{42};
+    std::uniform_real_distribution<float> position{-100.f, 100.f};
+    std::uniform_real_distribution<float> radius{.1f, 2.f};
+
+    VMVFrustumCuller culler{};
+    culler.Resize(sphereCount);
+    for (size_t i{}; i < sphereCount; ++i)
+    {
+        culler.SetSphere(i, {position(random), position(random), position(random)}, radius(random));
+    }
+
+    VMVCamera camera{};
+    camera.SetViewDirection({0.f, 0.f, -100.f}, {0.f, 0.f, 1.f});
+    camera.SetPerspectiveProjection(glm::radians(50.f), 16.f / 9.f, .1f, 200.f);
+    const std::array<glm::vec4, 6> planes{camera.GetFrustumPlanes()};
+
+    std::vector<uint32_t> visible{};
+    float scalarTime{};
+    for (Implementation implementation : {Implementation::Scalar, Implementation::Sse, Implementation::Avx})
+    {
+        if (!IsSupported(implementation))
+        {
+            std::cout << "Culling benchmark: " << GetImplementationName(implementation) << " not supported\n";
+            continue;
+        }
+
+        // One untimed run to fault in the output
+        uint32_t visibleCount{culler.Cull(planes, visible, implementation)};
+
+        using namespace std::chrono;
+        const time_point start{high_resolution_clock::now()};
+        for (uint32_t i{}; i < ITERATIONS; ++i)
+        {
+            visibleCount = culler.Cull(planes, visible, implementation);
+        }
+        const float time{duration<float, milliseconds::period>(high_resolution_clock::now() - start).count() /
+                         ITERATIONS};
+
+        if (implementation == Implementation::Scalar)
+        {
+            scalarTime = time;
+        }
+
+        std::cout << "Culling benchmark: " << GetImplementationName(implementation) << ", " << sphereCount
+                  << " spheres in " << time << "ms (" << static_cast<float>(sphereCount) / time / 1000.f
+                  << "M spheres/s, " << scalarTime / time << "x scalar), " << visibleCount << " visible\n";
+    }
+}
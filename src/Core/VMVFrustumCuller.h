@@ -0,0 +1,62 @@
+#ifndef VMV_VMVFRUSTUMCULLER_H
+#define VMV_VMVFRUSTUMCULLER_H
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace vmv
+{
+    // Tests world space bounding spheres against frustum planes on the CPU, 4 (SSE) or 8 (AVX) at a time.
+    // The spheres are kept as a structure of arrays so every plane test is a few multiply-adds over full
+    // registers, padding past the end is set up to always fail.
+    class VMVFrustumCuller final
+    {
+      public:
+        enum class Implementation
+        {
+            Scalar,
+            Sse,
+            Avx
+        };
+
+        void Resize(size_t count);
+        void SetSphere(size_t index, const glm::vec3& center, float radius);
+        size_t GetCount() const { return m_Count; }
+
+        // Writes the indices of the spheres intersecting the frustum to outVisible, returns how many there are.
+        // Planes are (normal, distance) facing inwards, see VMVCamera::GetFrustumPlanes.
+        uint32_t Cull(const std::array<glm::vec4, 6>& planes, std::vector<uint32_t>& outVisible) const;
+        uint32_t Cull(const std::array<glm::vec4, 6>& planes,
+                      std::vector<uint32_t>& outVisible,
+                      Implementation implementation) const;
+
+        // Fastest implementation this build and CPU support
+        static Implementation GetBestImplementation();
+        static bool IsSupported(Implementation implementation);
+        static const char* GetImplementationName(Implementation implementation);
+
+        // Culls sphereCount random spheres with every supported implementation and logs the throughput
+        static void RunBenchmark(size_t sphereCount);
+
+      private:
+        static constexpr size_t LANE_COUNT{8}; // widest implementation, arrays are padded to a multiple of it
+
+        std::vector<float> m_CentersX{};
+        std::vector<float> m_CentersY{};
+        std::vector<float> m_CentersZ{};
+        std::vector<float> m_Radii{};
+        size_t m_Count{};
+
+        uint32_t CullScalar(const std::array<glm::vec4, 6>& planes, uint32_t* pVisible) const;
+        uint32_t CullSse(const std::array<glm::vec4, 6>& planes, uint32_t* pVisible) const;
+        uint32_t CullAvx(const std::array<glm::vec4, 6>& planes, uint32_t* pVisible) const;
+    };
+} // namespace vmv
+
+#endif
\ No newline at end of file
@@ -1,7 +1,75 @@
 #include "VMVGameObject.h"
 
+#include <glm/gtc/constants.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace
+{
+    // The matrices as they were built before caching, each computing its own sines and cosines
+    glm::mat4 ComputeBaselineMat(const glm::vec3& translation, const glm::vec3& rotation, const glm::vec3& scale)
+    {
+        const float c3 = glm::cos(rotation.z);
+        const float s3 = glm::sin(rotation.z);
+        const float c2 = glm::cos(rotation.x);
+        const float s2 = glm::sin(rotation.x);
+        const float c1 = glm::cos(rotation.y);
+        const float s1 = glm::sin(rotation.y);
+        return glm::mat4{{
+                             scale.x * (c1 * c3 + s1 * s2 * s3),
+                             scale.x * (c2 * s3),
+                             scale.x * (c1 * s2 * s3 - c3 * s1),
+                             0.0f,
+                         },
+                         {
+                             scale.y * (c3 * s1 * s2 - c1 * s3),
+                             scale.y * (c2 * c3),
+                             scale.y * (c1 * c3 * s2 + s1 * s3),
+                             0.0f,
+                         },
+                         {
+                             scale.z * (c2 * s1),
+                             scale.z * (-s2),
+                             scale.z * (c1 * c2),
+                             0.0f,
+                         },
+                         {translation.x, translation.y, translation.z, 1.0f}};
+    }
+
+    glm::mat3 ComputeBaselineNormalMatrix(const glm::vec3& rotation, const glm::vec3& scale)
+    {
+        const float c3 = glm::cos(rotation.z);
+        const float s3 = glm::sin(rotation.z);
+        const float c2 = glm::cos(rotation.x);
+        const float s2 = glm::sin(rotation.x);
+        const float c1 = glm::cos(rotation.y);
+        const float s1 = glm::sin(rotation.y);
+
+        const glm::vec3 invScale = 1.f / scale;
+
+        return glm::mat3{{
+                             invScale.x * (c1 * c3 + s1 * s2 * s3),
+                             invScale.x * (c2 * s3),
+                             invScale.x * (c1 * s2 * s3 - c3 * s1),
+                         },
+                         {
+                             invScale.y * (c3 * s1 * s2 - c1 * s3),
+                             invScale.y * (c2 * c3),
+                             invScale.y * (c1 * c3 * s2 + s1 * s3),
+                         },
+                         {
+                             invScale.z * (c2 * s1),
+                             invScale.z * (-s2),
+                             invScale.z * (c1 * c2),
+                         }};
+    }
+} // namespace
+
 vmv::VMVGameObject vmv::VMVGameObject::CreateGameObject()
 {
     static id_t currentId;
@@ -10,59 +78,136 @@ vmv::VMVGameObject vmv::VMVGameObject::CreateGameObject()
 
 vmv::VMVGameObject::VMVGameObject(id_t id) : m_Id{id} {}
 
-glm::mat4 vmv::Transform::GetMat() const
+void vmv::Transform::SetTranslation(const glm::vec3& translation)
+{
+    if (translation != m_Translation)
+    {
+        m_Translation = translation;
+        MarkDirty();
+    }
+}
+
+void vmv::Transform::SetRotation(const glm::vec3& rotation)
+{
+    if (rotation != m_Rotation)
+    {
+        m_Rotation = rotation;
+        MarkDirty();
+    }
+}
+
+void vmv::Transform::SetScale(const glm::vec3& scale)
+{
+    if (scale != m_Scale)
+    {
+        m_Scale = scale;
+        MarkDirty();
+    }
+}
+
+const glm::mat4& vmv::Transform::GetMat() const
+{
+    if (m_IsDirty)
+    {
+        UpdateMatrices();
+    }
+    return m_Mat;
+}
+
+const glm::mat3& vmv::Transform::NormalMatrix() const
 {
-    const float c3 = glm::cos(rotation.z);
-    const float s3 = glm::sin(rotation.z);
-    const float c2 = glm::cos(rotation.x);
-    const float s2 = glm::sin(rotation.x);
-    const float c1 = glm::cos(rotation.y);
-    const float s1 = glm::sin(rotation.y);
-    return glm::mat4{{
-                         scale.x * (c1 * c3 + s1 * s2 * s3),
-                         scale.x * (c2 * s3),
-                         scale.x * (c1 * s2 * s3 - c3 * s1),
-                         0.0f,
-                     },
-                     {
-                         scale.y * (c3 * s1 * s2 - c1 * s3),
-                         scale.y * (c2 * c3),
-                         scale.y * (c1 * c3 * s2 + s1 * s3),
-                         0.0f,
-                     },
-                     {
-                         scale.z * (c2 * s1),
-                         scale.z * (-s2),
-                         scale.z * (c1 * c2),
-                         0.0f,
-                     },
-                     {translation.x, translation.y, translation.z, 1.0f}};
+    if (m_IsDirty)
+    {
+        UpdateMatrices();
+    }
+    return m_NormalMatrix;
 }
 
-glm::mat3 vmv::Transform::NormalMatrix() const
+void vmv::Transform::MarkDirty()
 {
-    const float c3 = glm::cos(rotation.z);
-    const float s3 = glm::sin(rotation.z);
-    const float c2 = glm::cos(rotation.x);
-    const float s2 = glm::sin(rotation.x);
-    const float c1 = glm::cos(rotation.y);
-    const float s1 = glm::sin(rotation.y);
-
-    const glm::vec3 invScale = 1.f / scale;
-
-    return glm::mat3{{
-                         invScale.x * (c1 * c3 + s1 * s2 * s3),
-                         invScale.x * (c2 * s3),
-                         invScale.x * (c1 * s2 * s3 - c3 * s1),
-                     },
-                     {
-                         invScale.y * (c3 * s1 * s2 - c1 * s3),
-                         invScale.y * (c2 * c3),
-                         invScale.y * (c1 * c3 * s2 + s1 * s3),
-                     },
-                     {
-                         invScale.z * (c2 * s1),
-                         invScale.z * (-s2),
-                         invScale.z * (c1 * c2),
-                     }};
+    m_IsDirty = true;
+}
+
+void vmv::Transform::UpdateMatrices() const
+{
+    const float c3 = glm::cos(m_Rotation.z);
+    const float s3 = glm::sin(m_Rotation.z);
+    const float c2 = glm::cos(m_Rotation.x);
+    const float s2 = glm::sin(m_Rotation.x);
+    const float c1 = glm::cos(m_Rotation.y);
+    const float s1 = glm::sin(m_Rotation.y);
+
+    // Both share the rotation, the normal matrix scales it by the inverse instead
+    const glm::vec3 x{c1 * c3 + s1 * s2 * s3, c2 * s3, c1 * s2 * s3 - c3 * s1};
+    const glm::vec3 y{c3 * s1 * s2 - c1 * s3, c2 * c3, c1 * c3 * s2 + s1 * s3};
+    const glm::vec3 z{c2 * s1, -s2, c1 * c2};
+
+    m_Mat = glm::mat4{glm::vec4{m_Scale.x * x, 0.f},
+                      glm::vec4{m_Scale.y * y, 0.f},
+                      glm::vec4{m_Scale.z * z, 0.f},
+                      glm::vec4{m_Translation, 1.f}};
+
+    const glm::vec3 invScale = 1.f / m_Scale;
+    m_NormalMatrix = glm::mat3{invScale.x * x, invScale.y * y, invScale.z * z};
+
+    m_IsDirty = false;
+}
+
+void vmv::Transform::RunBenchmark(size_t transformCount, float dynamicFraction)
+{
+    constexpr uint32_t FRAMES{20};
+
+    std::mt19937 random{42};
+    std::uniform_real_distribution<float> position{-100.f, 100.f};
+    std::uniform_real_distribution<float> angle{0.f, glm::two_pi<float>()};
+
+    std::vector<Transform> transforms(transformCount);
+    for (Transform& transform : transforms)
+    {
+        transform.SetTranslation({position(random), position(random), position(random)});
+        transform.SetRotation({angle(random), angle(random), angle(random)});
+    }
+
+    const size_t dynamicStride{
+        dynamicFraction > 0.f ? std::max(static_cast<size_t>(1.f / dynamicFraction), size_t{1}) : transformCount + 1};
+
+    // Stand in for the render system reading every matrix, summed so nothing gets optimized away
+    float checksum{};
+    const auto readMatrices{[&]() {
+        for (const Transform& transform : transforms)
+        {
+            checksum += transform.GetMat()[3].x + transform.NormalMatrix()[2].z;
+        }
+    }};
+    readMatrices();
+
+    using namespace std::chrono;
+    float recomputeTime{};
+    float cachedTime{};
+    for (uint32_t frame{}; frame < FRAMES; ++frame)
+    {
+        // The old behaviour, both matrices rebuilt from scratch every time they are read
+        time_point start{high_resolution_clock::now()};
+        for (const Transform& transform : transforms)
+        {
+            const glm::vec3& rotation{transform.GetRotation()};
+            checksum += ComputeBaselineMat(transform.GetTranslation(), rotation, transform.GetScale())[3].x +
+                        ComputeBaselineNormalMatrix(rotation, transform.GetScale())[2].z;
+        }
+        recomputeTime += duration<float, milliseconds::period>(high_resolution_clock::now() - start).count();
+
+        start = high_resolution_clock::now();
+        for (size_t i{}; i < transforms.size(); i += dynamicStride)
+        {
+            transforms[i].SetRotation(transforms[i].GetRotation() + glm::vec3{.01f, .02f, 0.f});
+        }
+        readMatrices();
+        cachedTime += duration<float, milliseconds::period>(high_resolution_clock::now() - start).count();
+    }
+    recomputeTime /= FRAMES;
+    cachedTime /= FRAMES;
+
+    std::cout << "Transform benchmark: " << transformCount << " transforms, " << dynamicFraction * 100.f
+              << "% dynamic: " << recomputeTime << "ms per frame recomputing all, " << cachedTime
+              << "ms per frame cached (" << recomputeTime / cachedTime << "x), checksum " << checksum << '\n';
 }
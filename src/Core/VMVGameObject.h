@@ -7,14 +7,38 @@
 
 namespace vmv
 {
-    struct Transform
+    // Translation, Tait-Bryan YXZ rotation and scale. The matrices are computed on first use after a setter
+    // changed something, so static objects cost nothing per frame. A transform must not be read from several
+    // threads while it is dirty.
+    class Transform final
     {
-        glm::vec3 translation{};
-        glm::vec3 scale{1.f, 1.f, 1.f};
-        glm::vec3 rotation{};
+      public:
+        const glm::vec3& GetTranslation() const { return m_Translation; }
+        const glm::vec3& GetRotation() const { return m_Rotation; }
+        const glm::vec3& GetScale() const { return m_Scale; }
+
+        void SetTranslation(const glm::vec3& translation);
+        void SetRotation(const glm::vec3& rotation);
+        void SetScale(const glm::vec3& scale);
+
+        const glm::mat4& GetMat() const;
+        const glm::mat3& NormalMatrix() const;
+
+        // Per frame cost of transformCount transforms with dynamicFraction of them changing every frame,
+        // cached against recomputing all matrices as before. CPU only.
+        static void RunBenchmark(size_t transformCount, float dynamicFraction);
+
+      private:
+        glm::vec3 m_Translation{};
+        glm::vec3 m_Rotation{};
+        glm::vec3 m_Scale{1.f, 1.f, 1.f};
+
+        mutable glm::mat4 m_Mat{1.f};
+        mutable glm::mat3 m_NormalMatrix{1.f};
+        mutable bool m_IsDirty{false};
 
-        glm::mat4 GetMat() const;
-        glm::mat3 NormalMatrix() const;
+        void MarkDirty();
+        void UpdateMatrices() const;
     };
 
     class VMVGameObject final
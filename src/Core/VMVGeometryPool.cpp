@@ -0,0 +1,103 @@
+#include "VMVGeometryPool.h"
+
+#include "VMVDevice.h"
+
+#include <algorithm>
+#include <cassert>
+
+vmv::VMVGeometryPool::VMVGeometryPool(VMVDevice& device) : m_VMVDevice{device} {}
+
+vmv::VMVGeometryPool::~VMVGeometryPool() {}
+
+vmv::VMVGeometryPool::Range vmv::VMVGeometryPool::Allocate(BufferType type,
+                                                           uint32_t elementSize,
+                                                           uint32_t elementCount)
+{
+    Range range{};
+    range.type = type;
+    range.elementSize = elementSize;
+    if (elementCount == 0)
+        return range;
+
+    uint64_t firstElement{};
+    Arena* pArena{nullptr};
+    for (Arena& arena : m_Arenas)
+    {
+        if (arena.type == type && arena.elementSize == elementSize &&
+            arena.ranges->Allocate(elementCount, 1, firstElement))
+        {
+            pArena = &arena;
+            break;
+        }
+    }
+
+    if (pArena == nullptr)
+    {
+        const VkDeviceSize bufferSize{type == BufferType::Vertex ? VERTEX_BUFFER_SIZE : INDEX_BUFFER_SIZE};
+        const uint32_t capacity{std::max(static_cast<uint32_t>(bufferSize / elementSize), elementCount)};
+
+        pArena = &CreateArena(type, elementSize, capacity);
+        [[maybe_unused]] const bool isAllocated{pArena->ranges->Allocate(elementCount, 1, firstElement)};
+        assert(isAllocated && "A new geometry pool buffer has to fit the range it was created for!");
+    }
+
+    ++pArena->rangeCount;
+    range.buffer = pArena->buffer->getBuffer();
+    range.firstElement = static_cast<uint32_t>(firstElement);
+    range.elementCount = elementCount;
+    return range;
+}
+
+void vmv::VMVGeometryPool::Free(const Range& range)
+{
+    if (range.elementCount == 0)
+        return;
+
+    const auto arenaIt{std::find_if(m_Arenas.begin(), m_Arenas.end(), [&range](const Arena& arena) {
+        return arena.buffer->getBuffer() == range.buffer;
+    })};
+    assert(arenaIt != m_Arenas.end() && "Range does not belong to this geometry pool!");
+
+    arenaIt->ranges->Free(range.firstElement, range.elementCount);
+    --arenaIt->rangeCount;
+
+    // Buffers made for a single oversized range would only waste memory once it is gone
+    const VkDeviceSize bufferSize{range.type == BufferType::Vertex ? VERTEX_BUFFER_SIZE : INDEX_BUFFER_SIZE};
+    if (arenaIt->rangeCount == 0 && arenaIt->buffer->getBufferSize() > bufferSize)
+    {
+        m_Arenas.erase(arenaIt);
+    }
+}
+
+vmv::VMVGeometryPool::Stats vmv::VMVGeometryPool::GetStats() const
+{
+    Stats stats{};
+    for (const Arena& arena : m_Arenas)
+    {
+        ++stats.bufferCount;
+        stats.rangeCount += arena.rangeCount;
+        stats.usedBytes += arena.ranges->GetUsedSize() * arena.elementSize;
+        stats.capacityBytes += arena.buffer->getBufferSize();
+    }
+    return stats;
+}
+
+vmv::VMVGeometryPool::Arena& vmv::VMVGeometryPool::CreateArena(BufferType type,
+                                                                uint32_t elementSize,
+                                                                uint32_t capacity)
+{
+    const bool isVertex{type == BufferType::Vertex};
+
+    Arena& arena{m_Arenas.emplace_back()};
+    arena.type = type;
+    arena.elementSize = elementSize;
+    arena.buffer = std::make_unique<VMVBuffer>(
+        m_VMVDevice,
+        elementSize,
+        capacity,
+        (isVertex ? VK_BUFFER_USAGE_VERTEX_BUFFER_BIT : VK_BUFFER_USAGE_INDEX_BUFFER_BIT) |
+            VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    arena.ranges = std::make_unique<VMVRangeAllocator>(capacity);
+    return arena;
+}
@@ -0,0 +1,83 @@
+#ifndef VMV_VMVGEOMETRYPOOL_H
+#define VMV_VMVGEOMETRYPOOL_H
+
+#include "VMVBuffer.h"
+#include "VMVRangeAllocator.h"
+
+#include <memory>
+#include <vector>
+
+namespace vmv
+{
+    class VMVDevice;
+
+    // Shared vertex and index storage for all models. Buffers are per usage and element size, e.g. 44-byte
+    // vertices or 16-bit indices, and another one of the same kind is added when they are full. Models are ranges
+    // inside them and draw through firstIndex/vertexOffset, so consecutive models only need a rebind when their
+    // layout or buffer differs.
+    class VMVGeometryPool final
+    {
+      public:
+        static constexpr VkDeviceSize VERTEX_BUFFER_SIZE{64 * 1024 * 1024};
+        static constexpr VkDeviceSize INDEX_BUFFER_SIZE{32 * 1024 * 1024};
+
+        enum class BufferType
+        {
+            Vertex,
+            Index
+        };
+
+        // Offsets and counts are in elements, not bytes
+        struct Range
+        {
+            VkBuffer buffer{VK_NULL_HANDLE};
+            uint32_t firstElement{};
+            uint32_t elementCount{};
+            uint32_t elementSize{};
+            BufferType type{BufferType::Vertex};
+
+            VkDeviceSize GetByteOffset() const { return static_cast<VkDeviceSize>(firstElement) * elementSize; }
+            VkDeviceSize GetByteSize() const { return static_cast<VkDeviceSize>(elementCount) * elementSize; }
+        };
+
+        struct Stats
+        {
+            uint32_t bufferCount{};
+            uint32_t rangeCount{};
+            VkDeviceSize usedBytes{};
+            VkDeviceSize capacityBytes{};
+        };
+
+        explicit VMVGeometryPool(VMVDevice& device);
+        ~VMVGeometryPool();
+
+        VMVGeometryPool(const VMVGeometryPool&) = delete;
+        VMVGeometryPool(VMVGeometryPool&&) noexcept = delete;
+        VMVGeometryPool& operator=(const VMVGeometryPool&) = delete;
+        VMVGeometryPool& operator=(VMVGeometryPool&&) noexcept = delete;
+
+        // Backing buffers are created when no existing one has room, ranges larger than the default buffer size
+        // get a buffer of their own that is destroyed again once freed
+        Range Allocate(BufferType type, uint32_t elementSize, uint32_t elementCount);
+        void Free(const Range& range);
+
+        Stats GetStats() const;
+
+      private:
+        struct Arena
+        {
+            BufferType type{};
+            uint32_t elementSize{};
+            std::unique_ptr<VMVBuffer> buffer{};
+            std::unique_ptr<VMVRangeAllocator> ranges{};
+            uint32_t rangeCount{};
+        };
+
+        VMVDevice& m_VMVDevice;
+        std::vector<Arena> m_Arenas{};
+
+        Arena& CreateArena(BufferType type, uint32_t elementSize, uint32_t capacity);
+    };
+} // namespace vmv
+
+#endif
\ No newline at end of file
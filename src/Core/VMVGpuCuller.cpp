@@ -0,0 +1,260 @@
+#include "VMVGpuCuller.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <stdexcept>
+
+vmv::VMVGpuCuller::VMVGpuCuller(VMVDevice& device, uint32_t frameCount) : m_VMVDevice{device}, m_Frames(frameCount)
+{
+    CreateDescriptorSetLayout();
+    CreatePipelineLayout();
+    m_pPipeline = std::make_unique<VMVPipeline>(m_VMVDevice, m_PipelineLayout, "Shaders/cull_instances.comp.spv");
+    CreateDescriptorSets();
+
+    for (Frame& frame : m_Frames)
+    {
+        EnsureCapacity(frame.instanceGroupBuffer,
+                       sizeof(uint32_t),
+                       MIN_CAPACITY,
+                       VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        EnsureCapacity(frame.groupBuffer,
+                       sizeof(Group),
+                       MIN_CAPACITY,
+                       VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        EnsureCapacity(frame.statsBuffer,
+                       sizeof(uint32_t),
+                       1,
+                       VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    }
+}
+
+vmv::VMVGpuCuller::~VMVGpuCuller()
+{
+    vkDestroyPipelineLayout(m_VMVDevice.device(), m_PipelineLayout, nullptr);
+    vkDestroyDescriptorPool(m_VMVDevice.device(), m_DescriptorPool, nullptr);
+    vkDestroyDescriptorSetLayout(m_VMVDevice.device(), m_DescriptorSetLayout, nullptr);
+}
+
+uint32_t* vmv::VMVGpuCuller::MapInstanceGroups(size_t frameIndex, uint32_t instanceCount)
+{
+    Frame& frame{m_Frames[frameIndex]};
+    EnsureCapacity(frame.instanceGroupBuffer,
+                   sizeof(uint32_t),
+                   instanceCount,
+                   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    return static_cast<uint32_t*>(frame.instanceGroupBuffer->getMappedMemory());
+}
+
+vmv::VMVGpuCuller::Group* vmv::VMVGpuCuller::MapGroups(size_t frameIndex, uint32_t groupCount)
+{
+    Frame& frame{m_Frames[frameIndex]};
+    EnsureCapacity(frame.groupBuffer,
+                   sizeof(Group),
+                   groupCount,
+                   VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    return static_cast<Group*>(frame.groupBuffer->getMappedMemory());
+}
+
+void vmv::VMVGpuCuller::Dispatch(VkCommandBuffer commandBuffer,
+                                 size_t frameIndex,
+                                 const std::array<glm::vec4, 6>& frustumPlanes,
+                                 const VMVBuffer& instanceBuffer,
+                                 uint32_t instanceCount,
+                                 const VMVBuffer& indirectBuffer)
+{
+    Frame& frame{m_Frames[frameIndex]};
+
+    // The frame's previous submission has completed, collect its counts before the buffer is reused
+    ReadStats(frame);
+    *static_cast<uint32_t*>(frame.statsBuffer->getMappedMemory()) = 0;
+    frame.dispatchedInstances = instanceCount;
+
+    if (instanceCount == 0)
+        return;
+
+    EnsureCapacity(frame.visibleInstanceBuffer,
+                   instanceBuffer.getInstanceSize(),
+                   instanceCount,
+                   VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    // Cheap to rewrite every frame and covers buffers replaced by any of the Map calls
+    const std::array<VkBuffer, BINDING_COUNT> buffers{instanceBuffer.getBuffer(),
+                                                      frame.instanceGroupBuffer->getBuffer(),
+                                                      frame.groupBuffer->getBuffer(),
+                                                      frame.visibleInstanceBuffer->getBuffer(),
+                                                      indirectBuffer.getBuffer(),
+                                                      frame.statsBuffer->getBuffer()};
+    std::array<VkDescriptorBufferInfo, BINDING_COUNT> bufferInfos{};
+    std::array<VkWriteDescriptorSet, BINDING_COUNT> descriptorWrites{};
+    for (uint32_t i{}; i < BINDING_COUNT; ++i)
+    {
+        bufferInfos[i].buffer = buffers[i];
+        bufferInfos[i].offset = 0;
+        bufferInfos[i].range = VK_WHOLE_SIZE;
+
+        descriptorWrites[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrites[i].dstSet = frame.descriptorSet;
+        descriptorWrites[i].dstBinding = i;
+        descriptorWrites[i].dstArrayElement = 0;
+        descriptorWrites[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        descriptorWrites[i].descriptorCount = 1;
+        descriptorWrites[i].pBufferInfo = &bufferInfos[i];
+    }
+    vkUpdateDescriptorSets(m_VMVDevice.device(),
+                           static_cast<uint32_t>(descriptorWrites.size()),
+                           descriptorWrites.data(),
+                           0,
+                           nullptr);
+
+    PushConstants push{};
+    std::copy(frustumPlanes.begin(), frustumPlanes.end(), push.frustumPlanes);
+    push.instanceCount = instanceCount;
+
+    m_pPipeline->Bind(commandBuffer);
+    vkCmdBindDescriptorSets(commandBuffer,
+                            VK_PIPELINE_BIND_POINT_COMPUTE,
+                            m_PipelineLayout,
+                            0,
+                            1,
+                            &frame.descriptorSet,
+                            0,
+                            nullptr);
+    vkCmdPushConstants(
+        commandBuffer, m_PipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants), &push);
+    vkCmdDispatch(commandBuffer, (instanceCount + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1);
+
+    // The fence wait before ReadStats doesn't make the counts visible to the host on its own, the host read has to
+    // be part of the barrier too
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask =
+        VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_HOST_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer,
+                         VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                         VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+                             VK_PIPELINE_STAGE_HOST_BIT,
+                         0,
+                         1,
+                         &barrier,
+                         0,
+                         nullptr,
+                         0,
+                         nullptr);
+}
+
+const vmv::VMVBuffer& vmv::VMVGpuCuller::GetVisibleInstanceBuffer(size_t frameIndex) const
+{
+    assert(m_Frames[frameIndex].visibleInstanceBuffer && "Nothing has been dispatched for this frame!");
+    return *m_Frames[frameIndex].visibleInstanceBuffer;
+}
+
+void vmv::VMVGpuCuller::CreateDescriptorSetLayout()
+{
+    std::array<VkDescriptorSetLayoutBinding, BINDING_COUNT> bindings{};
+    for (uint32_t i{}; i < BINDING_COUNT; ++i)
+    {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
+
+    if (vkCreateDescriptorSetLayout(m_VMVDevice.device(), &layoutInfo, nullptr, &m_DescriptorSetLayout) != VK_SUCCESS)
+    {
+        throw std::runtime_error{"Failed to create culling descriptor set layout!"};
+    }
+}
+
+void vmv::VMVGpuCuller::CreatePipelineLayout()
+{
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(PushConstants);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &m_DescriptorSetLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+    if (vkCreatePipelineLayout(m_VMVDevice.device(), &pipelineLayoutInfo, nullptr, &m_PipelineLayout) != VK_SUCCESS)
+    {
+        throw std::runtime_error{"Failed to create culling pipeline layout!"};
+    }
+}
+
+void vmv::VMVGpuCuller::CreateDescriptorSets()
+{
+    const uint32_t frameCount{static_cast<uint32_t>(m_Frames.size())};
+
+    VkDescriptorPoolSize poolSize{};
+    poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSize.descriptorCount = BINDING_COUNT * frameCount;
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    poolInfo.maxSets = frameCount;
+
+    if (vkCreateDescriptorPool(m_VMVDevice.device(), &poolInfo, nullptr, &m_DescriptorPool) != VK_SUCCESS)
+    {
+        throw std::runtime_error{"Failed to create culling Descriptor Pool!"};
+    }
+
+    std::vector<VkDescriptorSetLayout> layouts{frameCount, m_DescriptorSetLayout};
+    std::vector<VkDescriptorSet> descriptorSets(frameCount);
+
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = m_DescriptorPool;
+    allocInfo.descriptorSetCount = frameCount;
+    allocInfo.pSetLayouts = layouts.data();
+
+    if (vkAllocateDescriptorSets(m_VMVDevice.device(), &allocInfo, descriptorSets.data()) != VK_SUCCESS)
+    {
+        throw std::runtime_error{"Failed to allocate culling Descriptor Sets!"};
+    }
+
+    for (size_t i{}; i < m_Frames.size(); ++i)
+    {
+        m_Frames[i].descriptorSet = descriptorSets[i];
+    }
+}
+
+void vmv::VMVGpuCuller::EnsureCapacity(std::unique_ptr<VMVBuffer>& buffer,
+                                       VkDeviceSize elementSize,
+                                       uint32_t count,
+                                       VkMemoryPropertyFlags memoryPropertyFlags)
+{
+    if (buffer && buffer->getInstanceCount() >= count)
+        return;
+
+    // Only called while the frame owning the buffer is not in flight, so it can be replaced right away
+    buffer = std::make_unique<VMVBuffer>(m_VMVDevice,
+                                         elementSize,
+                                         std::bit_ceil(std::max(count, MIN_CAPACITY)),
+                                         VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                                         memoryPropertyFlags);
+    if (memoryPropertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+    {
+        buffer->map();
+    }
+}
+
+void vmv::VMVGpuCuller::ReadStats(Frame& frame)
+{
+    const uint32_t visibleCount{*static_cast<const uint32_t*>(frame.statsBuffer->getMappedMemory())};
+    frame.stats.instanceCount = frame.dispatchedInstances;
+    frame.stats.visibleCount = std::min(visibleCount, frame.dispatchedInstances);
+    frame.stats.culledCount = frame.dispatchedInstances - frame.stats.visibleCount;
+}
@@ -0,0 +1,108 @@
+#ifndef VMV_VMVGPUCULLER_H
+#define VMV_VMVGPUCULLER_H
+
+#include "VMVBuffer.h"
+#include "VMVPipeline.h"
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+#include <array>
+#include <memory>
+#include <vector>
+
+namespace vmv
+{
+    // Frustum culls instances on the GPU with cull_instances.comp. Takes an instance buffer where every model
+    // (group) owns a contiguous range, plus indirect commands with instanceCount 0, and writes the visible
+    // instances of each group to the front of its range while counting them into the commands.
+    class VMVGpuCuller final
+    {
+      public:
+        struct Group // std430, matches Group in cull_instances.comp
+        {
+            glm::vec4 boundingSphere{}; // see VMVModel::GetVertexBoundingSphere
+            uint32_t firstCommand{};
+            uint32_t commandCount{}; // 0 passes the group's instances through unculled
+            uint32_t padding[2]{};
+        };
+
+        struct Stats
+        {
+            uint32_t instanceCount{};
+            uint32_t visibleCount{};
+            uint32_t culledCount{};
+        };
+
+        VMVGpuCuller(VMVDevice& device, uint32_t frameCount);
+        ~VMVGpuCuller();
+
+        VMVGpuCuller(const VMVGpuCuller&) = delete;
+        VMVGpuCuller(VMVGpuCuller&&) noexcept = delete;
+        VMVGpuCuller& operator=(const VMVGpuCuller&) = delete;
+        VMVGpuCuller& operator=(VMVGpuCuller&&) noexcept = delete;
+
+        // Per frame inputs, the group index of every instance and the group table. The frame's previous
+        // submission must have completed, the memory is valid until the next call for the same frame.
+        uint32_t* MapInstanceGroups(size_t frameIndex, uint32_t instanceCount);
+        Group* MapGroups(size_t frameIndex, uint32_t groupCount);
+
+        // Records the dispatch and a barrier for the indirect draws and vertex shaders reading the results,
+        // so it has to be recorded outside of a render pass
+        void Dispatch(VkCommandBuffer commandBuffer,
+                      size_t frameIndex,
+                      const std::array<glm::vec4, 6>& frustumPlanes,
+                      const VMVBuffer& instanceBuffer,
+                      uint32_t instanceCount,
+                      const VMVBuffer& indirectBuffer);
+
+        // Written by Dispatch, replaced when it has to grow
+        const VMVBuffer& GetVisibleInstanceBuffer(size_t frameIndex) const;
+
+        // Counts of the frame's previous dispatch, so they lag the current frame by the frames in flight
+        const Stats& GetStats(size_t frameIndex) const { return m_Frames[frameIndex].stats; }
+
+      private:
+        struct PushConstants
+        {
+            glm::vec4 frustumPlanes[6];
+            uint32_t instanceCount;
+        };
+
+        struct Frame
+        {
+            std::unique_ptr<VMVBuffer> instanceGroupBuffer;
+            std::unique_ptr<VMVBuffer> groupBuffer;
+            std::unique_ptr<VMVBuffer> visibleInstanceBuffer;
+            std::unique_ptr<VMVBuffer> statsBuffer;
+            VkDescriptorSet descriptorSet{VK_NULL_HANDLE};
+            uint32_t dispatchedInstances{};
+            Stats stats{};
+        };
+
+        static constexpr uint32_t MIN_CAPACITY{1024};
+        static constexpr uint32_t WORKGROUP_SIZE{64}; // local_size_x in cull_instances.comp
+        static constexpr uint32_t BINDING_COUNT{6};
+
+        VMVDevice& m_VMVDevice;
+
+        VkDescriptorSetLayout m_DescriptorSetLayout;
+        VkPipelineLayout m_PipelineLayout;
+        VkDescriptorPool m_DescriptorPool;
+        std::unique_ptr<VMVPipeline> m_pPipeline;
+
+        std::vector<Frame> m_Frames;
+
+        void CreateDescriptorSetLayout();
+        void CreatePipelineLayout();
+        void CreateDescriptorSets();
+        void EnsureCapacity(std::unique_ptr<VMVBuffer>& buffer,
+                            VkDeviceSize elementSize,
+                            uint32_t count,
+                            VkMemoryPropertyFlags memoryPropertyFlags);
+        void ReadStats(Frame& frame);
+    };
+} // namespace vmv
+
+#endif
\ No newline at end of file
@@ -0,0 +1,193 @@
+#include "VMVMemoryAllocator.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+vmv::VMVMemoryAllocator::VMVMemoryAllocator(VkDevice device, VkPhysicalDevice physicalDevice, VkDeviceSize blockSize)
+    : m_Device{device}, m_BlockSize{blockSize}
+{
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &m_MemoryProperties);
+    m_BlockLists.resize(static_cast<size_t>(m_MemoryProperties.memoryTypeCount) * 2);
+
+    VkPhysicalDeviceProperties properties{};
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    m_NonCoherentAtomSize = std::max<VkDeviceSize>(properties.limits.nonCoherentAtomSize, 1);
+}
+
+vmv::VMVMemoryAllocator::~VMVMemoryAllocator()
+{
+    for (std::vector<Block>& blocks : m_BlockLists)
+    {
+        for (Block& block : blocks)
+        {
+            if (block.memory != VK_NULL_HANDLE)
+            {
+                vkFreeMemory(m_Device, block.memory, nullptr);
+            }
+        }
+    }
+}
+
+vmv::VMVMemoryAllocator::Allocation vmv::VMVMemoryAllocator::Allocate(const VkMemoryRequirements& requirements,
+                                                                      VkMemoryPropertyFlags properties,
+                                                                      bool isLinear)
+{
+    Allocation allocation{};
+    allocation.memoryTypeIndex = FindMemoryType(requirements.memoryTypeBits, properties);
+    allocation.size = requirements.size;
+    allocation.isLinear = isLinear;
+
+    const VkMemoryPropertyFlags typeFlags{m_MemoryProperties.memoryTypes[allocation.memoryTypeIndex].propertyFlags};
+    VkDeviceSize alignment{requirements.alignment};
+    if ((typeFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) && !(typeFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
+    {
+        // Keeps flush/invalidate ranges of neighbouring allocations from overlapping
+        alignment = std::max(alignment, m_NonCoherentAtomSize);
+    }
+
+    // Anything bigger than half a block would mostly waste the rest of it
+    if (requirements.size > m_BlockSize / 2)
+    {
+        allocation.memory = AllocateMemory(requirements.size, allocation.memoryTypeIndex, allocation.pMapped);
+        allocation.isDedicated = true;
+        ++m_DedicatedAllocationCount;
+        m_DedicatedBytes += requirements.size;
+        return allocation;
+    }
+
+    std::vector<Block>& blocks{m_BlockLists[allocation.memoryTypeIndex * 2 + (isLinear ? 1 : 0)]};
+
+    uint64_t offset{};
+    size_t blockIndex{};
+    size_t freeSlot{blocks.size()};
+    for (; blockIndex < blocks.size(); ++blockIndex)
+    {
+        Block& block{blocks[blockIndex]};
+        if (block.memory == VK_NULL_HANDLE)
+        {
+            freeSlot = std::min(freeSlot, blockIndex);
+            continue;
+        }
+        if (block.ranges->Allocate(requirements.size, alignment, offset))
+            break;
+    }
+
+    if (blockIndex == blocks.size())
+    {
+        blockIndex = freeSlot;
+        if (blockIndex == blocks.size())
+        {
+            blocks.emplace_back();
+        }
+
+        Block& block{blocks[blockIndex]};
+        block.memory = AllocateMemory(m_BlockSize, allocation.memoryTypeIndex, block.pMapped);
+        block.ranges = std::make_unique<VMVRangeAllocator>(m_BlockSize);
+        block.ranges->Allocate(requirements.size, alignment, offset);
+    }
+
+    Block& block{blocks[blockIndex]};
+    ++block.allocationCount;
+
+    allocation.memory = block.memory;
+    allocation.offset = offset;
+    allocation.blockIndex = static_cast<uint32_t>(blockIndex);
+    allocation.pMapped = block.pMapped != nullptr ? static_cast<char*>(block.pMapped) + offset : nullptr;
+    return allocation;
+}
+
+void vmv::VMVMemoryAllocator::Free(const Allocation& allocation)
+{
+    if (allocation.memory == VK_NULL_HANDLE)
+        return;
+
+    if (allocation.isDedicated)
+    {
+        vkFreeMemory(m_Device, allocation.memory, nullptr);
+        --m_DedicatedAllocationCount;
+        m_DedicatedBytes -= allocation.size;
+        return;
+    }
+
+    std::vector<Block>& blocks{m_BlockLists[allocation.memoryTypeIndex * 2 + (allocation.isLinear ? 1 : 0)]};
+    Block& block{blocks[allocation.blockIndex]};
+    block.ranges->Free(allocation.offset, allocation.size);
+
+    // Empty blocks go back to the driver, except the last one of a type to avoid churn on alloc/free cycles
+    if (--block.allocationCount == 0)
+    {
+        const size_t liveBlocks{static_cast<size_t>(std::count_if(
+            blocks.begin(), blocks.end(), [](const Block& other) { return other.memory != VK_NULL_HANDLE; }))};
+        if (liveBlocks > 1)
+        {
+            vkFreeMemory(m_Device, block.memory, nullptr);
+            block = {};
+        }
+    }
+}
+
+uint32_t vmv::VMVMemoryAllocator::FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const
+{
+    for (uint32_t i = 0; i < m_MemoryProperties.memoryTypeCount; i++)
+    {
+        if ((typeFilter & (1 << i)) && (m_MemoryProperties.memoryTypes[i].propertyFlags & properties) == properties)
+        {
+            return i;
+        }
+    }
+
+    throw std::runtime_error("Failed to find suitable memory type!");
+}
+
+vmv::VMVMemoryAllocator::Stats vmv::VMVMemoryAllocator::GetStats() const
+{
+    Stats stats{};
+    stats.dedicatedAllocationCount = m_DedicatedAllocationCount;
+    stats.allocationCount = m_DedicatedAllocationCount;
+    stats.reservedBytes = m_DedicatedBytes;
+    stats.usedBytes = m_DedicatedBytes;
+
+    VkDeviceSize largestFreeRanges{};
+    for (const std::vector<Block>& blocks : m_BlockLists)
+    {
+        for (const Block& block : blocks)
+        {
+            if (block.memory == VK_NULL_HANDLE)
+                continue;
+
+            ++stats.blockCount;
+            stats.allocationCount += block.allocationCount;
+            stats.reservedBytes += block.ranges->GetCapacity();
+            stats.usedBytes += block.ranges->GetUsedSize();
+            stats.freeBytes += block.ranges->GetCapacity() - block.ranges->GetUsedSize();
+            stats.freeRangeCount += static_cast<uint32_t>(block.ranges->GetFreeRangeCount());
+            largestFreeRanges += block.ranges->GetLargestFreeRange();
+        }
+    }
+
+    stats.fragmentation = stats.freeBytes > 0 ? 1.f - static_cast<float>(largestFreeRanges) /
+                                                          static_cast<float>(stats.freeBytes)
+                                              : 0.f;
+    return stats;
+}
+
+VkDeviceMemory vmv::VMVMemoryAllocator::AllocateMemory(VkDeviceSize size, uint32_t memoryTypeIndex, void*& outMapped)
+{
+    VkMemoryAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = size;
+    allocInfo.memoryTypeIndex = memoryTypeIndex;
+
+    VkDeviceMemory memory{VK_NULL_HANDLE};
+    if (vkAllocateMemory(m_Device, &allocInfo, nullptr, &memory) != VK_SUCCESS)
+        throw std::runtime_error("Failed to allocate device memory!");
+
+    outMapped = nullptr;
+    if (m_MemoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+    {
+        if (vkMapMemory(m_Device, memory, 0, VK_WHOLE_SIZE, 0, &outMapped) != VK_SUCCESS)
+            throw std::runtime_error("Failed to map device memory!");
+    }
+
+    return memory;
+}
@@ -0,0 +1,86 @@
+#ifndef VMV_VMVMEMORYALLOCATOR_H
+#define VMV_VMVMEMORYALLOCATOR_H
+
+#include "VMVRangeAllocator.h"
+
+#include <vulkan/vulkan.h>
+
+#include <memory>
+#include <vector>
+
+namespace vmv
+{
+    // Sub-allocates buffers and images out of large VkDeviceMemory blocks, one block list per memory type,
+    // so the number of vkAllocateMemory calls stays far below maxMemoryAllocationCount.
+    // Host-visible blocks are mapped once for their whole lifetime.
+    class VMVMemoryAllocator final
+    {
+      public:
+        static constexpr VkDeviceSize DEFAULT_BLOCK_SIZE{64 * 1024 * 1024};
+
+        struct Allocation
+        {
+            VkDeviceMemory memory{VK_NULL_HANDLE};
+            VkDeviceSize offset{};
+            VkDeviceSize size{};
+            void* pMapped{nullptr}; // already offset, nullptr for memory that is not host visible
+            uint32_t memoryTypeIndex{};
+            uint32_t blockIndex{};
+            bool isLinear{true};
+            bool isDedicated{false};
+        };
+
+        struct Stats
+        {
+            uint32_t blockCount{};
+            uint32_t dedicatedAllocationCount{};
+            uint32_t allocationCount{};
+            VkDeviceSize reservedBytes{}; // all device memory allocated, blocks and dedicated
+            VkDeviceSize usedBytes{};
+            VkDeviceSize freeBytes{};     // unused space inside blocks
+            uint32_t freeRangeCount{};
+            float fragmentation{};        // 1 - (sum of each block's largest free range) / free bytes
+        };
+
+        VMVMemoryAllocator(VkDevice device,
+                           VkPhysicalDevice physicalDevice,
+                           VkDeviceSize blockSize = DEFAULT_BLOCK_SIZE);
+        ~VMVMemoryAllocator();
+
+        VMVMemoryAllocator(const VMVMemoryAllocator&) = delete;
+        VMVMemoryAllocator(VMVMemoryAllocator&&) noexcept = delete;
+        VMVMemoryAllocator& operator=(const VMVMemoryAllocator&) = delete;
+        VMVMemoryAllocator& operator=(VMVMemoryAllocator&&) noexcept = delete;
+
+        // isLinear separates buffers from optimal tiling images so bufferImageGranularity never applies
+        Allocation Allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, bool isLinear);
+        void Free(const Allocation& allocation);
+
+        uint32_t FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
+        Stats GetStats() const;
+
+      private:
+        struct Block
+        {
+            VkDeviceMemory memory{VK_NULL_HANDLE};
+            void* pMapped{nullptr};
+            std::unique_ptr<VMVRangeAllocator> ranges{};
+            uint32_t allocationCount{};
+        };
+
+        // Index is memoryTypeIndex * 2 + isLinear
+        std::vector<std::vector<Block>> m_BlockLists{};
+
+        VkDevice m_Device;
+        VkPhysicalDeviceMemoryProperties m_MemoryProperties{};
+        VkDeviceSize m_BlockSize;
+        VkDeviceSize m_NonCoherentAtomSize{1};
+
+        uint32_t m_DedicatedAllocationCount{};
+        VkDeviceSize m_DedicatedBytes{};
+
+        VkDeviceMemory AllocateMemory(VkDeviceSize size, uint32_t memoryTypeIndex, void*& outMapped);
+    };
+} // namespace vmv
+
+#endif
\ No newline at end of file
@@ -0,0 +1,138 @@
+#include "VMVMeshCache.h"
+
+#include "VMVUtils.h"
+
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+#include <type_traits>
+
+static_assert(std::is_trivially_copyable_v<vmv::VMVModel::Vertex>, "Mesh cache stores vertices as raw bytes!");
+static_assert(sizeof(vmv::VMVMeshCache::Header) % 8 == 0, "Mesh cache header must keep the vertex data aligned!");
+
+std::string vmv::VMVMeshCache::GetCachePath(const std::string& sourcePath)
+{
+    return sourcePath + ".vmvmesh";
+}
+
+bool vmv::VMVMeshCache::MakeHeader(const std::string& sourcePath, Header& header)
+{
+    std::error_code error{};
+    const uintmax_t sourceSize{std::filesystem::file_size(sourcePath, error)};
+    if (error)
+        return false;
+
+    const std::filesystem::file_time_type writeTime{std::filesystem::last_write_time(sourcePath, error)};
+    if (error)
+        return false;
+
+    header = Header{};
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.vertexSize = sizeof(VMVModel::Vertex);
+    header.indexSize = sizeof(uint32_t);
+    header.sourcePathHash = hashBytes(sourcePath.data(), sourcePath.size());
+    header.sourceSize = static_cast<uint64_t>(sourceSize);
+    header.sourceWriteTime = static_cast<int64_t>(writeTime.time_since_epoch().count());
+
+    return true;
+}
+
+bool vmv::VMVMeshCache::Load(const std::string& sourcePath, VMVModel::Builder& builder)
+{
+    Header expected{};
+    if (!MakeHeader(sourcePath, expected))
+        return false;
+
+    std::ifstream file{GetCachePath(sourcePath), std::ios::ate | std::ios::binary};
+    if (!file.is_open())
+        return false;
+
+    const uint64_t fileSize{static_cast<uint64_t>(file.tellg())};
+    if (fileSize < sizeof(Header))
+        return false;
+
+    Header header{};
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(&header), sizeof(Header));
+
+    if (header.magic != expected.magic || header.version != expected.version ||
+        header.vertexSize != expected.vertexSize || header.indexSize != expected.indexSize ||
+        header.sourcePathHash != expected.sourcePathHash || header.sourceSize != expected.sourceSize ||
+        header.sourceWriteTime != expected.sourceWriteTime)
+    {
+        return false;
+    }
+
+    // Check the counts against the bytes actually there before multiplying, a corrupt count must neither
+    // overflow nor make the resizes below allocate more than the file holds
+    const uint64_t dataSize{fileSize - sizeof(Header)};
+    if (header.vertexCount > dataSize / header.vertexSize)
+        return false;
+
+    const uint64_t vertexBytes{header.vertexCount * header.vertexSize};
+    if (header.indexCount > (dataSize - vertexBytes) / header.indexSize)
+        return false;
+
+    const uint64_t indexBytes{header.indexCount * header.indexSize};
+    if (dataSize != vertexBytes + indexBytes)
+        return false;
+
+    // Raw reads straight into the builder storage, no parsing or per-element work
+    builder.vertices.resize(header.vertexCount);
+    builder.indices.resize(header.indexCount);
+    file.read(reinterpret_cast<char*>(builder.vertices.data()), static_cast<std::streamsize>(vertexBytes));
+    file.read(reinterpret_cast<char*>(builder.indices.data()), static_cast<std::streamsize>(indexBytes));
+
+    if (!file)
+    {
+        builder.vertices.clear();
+        builder.indices.clear();
+        return false;
+    }
+
+    return true;
+}
+
+void vmv::VMVMeshCache::Save(const std::string& sourcePath, const VMVModel::Builder& builder)
+{
+    Header header{};
+    if (!MakeHeader(sourcePath, header))
+        return;
+
+    header.vertexCount = builder.vertices.size();
+    header.indexCount = builder.indices.size();
+
+    // Write to a temporary file first so a crash never leaves a truncated cache behind
+    const std::string cachePath{GetCachePath(sourcePath)};
+    const std::string tempPath{cachePath + ".tmp"};
+    bool isWritten{false};
+    {
+        std::ofstream file{tempPath, std::ios::binary | std::ios::trunc};
+        if (!file.is_open())
+            return;
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+        file.write(reinterpret_cast<const char*>(builder.vertices.data()),
+                   static_cast<std::streamsize>(header.vertexCount * header.vertexSize));
+        file.write(reinterpret_cast<const char*>(builder.indices.data()),
+                   static_cast<std::streamsize>(header.indexCount * header.indexSize));
+
+        file.close(); // flushes, so a full disk shows up here
+        isWritten = !file.fail();
+    }
+
+    // Never leave a partially written temporary file behind
+    std::error_code error{};
+    if (!isWritten)
+    {
+        std::filesystem::remove(tempPath, error);
+        return;
+    }
+
+    std::filesystem::rename(tempPath, cachePath, error);
+    if (error)
+    {
+        std::filesystem::remove(tempPath, error);
+    }
+}
@@ -0,0 +1,45 @@
+#ifndef VMV_VMVMESHCACHE_H
+#define VMV_VMVMESHCACHE_H
+
+#include "VMVModel.h"
+
+#include <cstdint>
+#include <string>
+
+namespace vmv
+{
+    // Binary mesh cache written next to the source file as "<source>.vmvmesh".
+    // File layout: Header | Vertex[vertexCount] | uint32_t[indexCount], with every section 8-byte aligned
+    // so the file can be memory-mapped and handed to a staging buffer as-is.
+    class VMVMeshCache final
+    {
+      public:
+        static constexpr uint32_t MAGIC{0x484D4D56}; // "VMMH"
+        static constexpr uint32_t VERSION{2};
+
+        struct Header
+        {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t vertexSize;
+            uint32_t indexSize;
+            uint64_t sourcePathHash;
+            uint64_t sourceSize;
+            int64_t sourceWriteTime;
+            uint64_t vertexCount;
+            uint64_t indexCount;
+            uint64_t reserved;
+        };
+
+        static std::string GetCachePath(const std::string& sourcePath);
+
+        // Fills the builder from the cache if it exists and still matches the source file, returns false otherwise
+        static bool Load(const std::string& sourcePath, VMVModel::Builder& builder);
+        static void Save(const std::string& sourcePath, const VMVModel::Builder& builder);
+
+      private:
+        static bool MakeHeader(const std::string& sourcePath, Header& header);
+    };
+} // namespace vmv
+
+#endif
\ No newline at end of file
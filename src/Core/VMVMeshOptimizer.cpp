@@ -0,0 +1,321 @@
+#include "VMVMeshOptimizer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <numeric>
+
+namespace
+{
+    // Triangles are only split into overdraw clusters at Tipsify dead ends or after this many triangles
+    constexpr uint32_t MAX_CLUSTER_TRIANGLES{256};
+} // namespace
+
+void vmv::VMVMeshOptimizer::Optimize(VMVModel::Builder& builder, bool optimizeOverdraw)
+{
+    if (builder.indices.size() < 3)
+        return;
+
+    std::vector<uint32_t> clusterStarts{};
+    builder.indices = OptimizeVertexCache(builder.indices, builder.vertices.size(), &clusterStarts);
+
+    if (optimizeOverdraw)
+    {
+        builder.indices = OptimizeOverdraw(builder.indices, builder.vertices, clusterStarts);
+    }
+
+    OptimizeVertexFetch(builder.vertices, builder.indices);
+}
+
+std::vector<uint32_t> vmv::VMVMeshOptimizer::OptimizeVertexCache(const std::vector<uint32_t>& indices,
+                                                                 size_t vertexCount,
+                                                                 std::vector<uint32_t>* pClusterStarts)
+{
+    const size_t triangleCount{indices.size() / 3};
+
+    // Vertex -> triangle adjacency in compressed rows
+    std::vector<uint32_t> liveTriangles(vertexCount, 0);
+    for (size_t i{}; i < triangleCount * 3; ++i)
+    {
+        ++liveTriangles[indices[i]];
+    }
+
+    std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+    std::partial_sum(liveTriangles.begin(), liveTriangles.end(), adjacencyOffsets.begin() + 1);
+
+    std::vector<uint32_t> adjacency(adjacencyOffsets.back());
+    {
+        std::vector<uint32_t> cursor(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for (size_t triangle{}; triangle < triangleCount; ++triangle)
+        {
+            for (size_t corner{}; corner < 3; ++corner)
+            {
+                adjacency[cursor[indices[triangle * 3 + corner]]++] = static_cast<uint32_t>(triangle);
+            }
+        }
+    }
+
+    std::vector<uint32_t> cacheTimeStamps(vertexCount, 0);
+    std::vector<bool> isEmitted(triangleCount, false);
+    std::vector<uint32_t> deadEndStack{};
+    std::vector<uint32_t> candidates{};
+
+    std::vector<uint32_t> output{};
+    output.reserve(triangleCount * 3);
+
+    const auto skipDeadEnd{[&](size_t& vertexCursor) -> int64_t {
+        while (!deadEndStack.empty())
+        {
+            const uint32_t vertex{deadEndStack.back()};
+            deadEndStack.pop_back();
+            if (liveTriangles[vertex] > 0)
+                return vertex;
+        }
+        for (; vertexCursor < vertexCount; ++vertexCursor)
+        {
+            if (liveTriangles[vertexCursor] > 0)
+                return static_cast<int64_t>(vertexCursor);
+        }
+        return -1;
+    }};
+
+    uint32_t timeStamp{CACHE_SIZE + 1};
+    size_t vertexCursor{};
+    int64_t fanVertex{skipDeadEnd(vertexCursor)};
+
+    if (pClusterStarts != nullptr)
+    {
+        pClusterStarts->assign(1, 0);
+    }
+
+    while (fanVertex >= 0)
+    {
+        candidates.clear();
+
+        // Emit every remaining triangle around the fanning vertex
+        for (uint32_t i{adjacencyOffsets[fanVertex]}; i < adjacencyOffsets[fanVertex + 1]; ++i)
+        {
+            const uint32_t triangle{adjacency[i]};
+            if (isEmitted[triangle])
+                continue;
+
+            for (size_t corner{}; corner < 3; ++corner)
+            {
+                const uint32_t vertex{indices[triangle * 3 + corner]};
+                output.push_back(vertex);
+                deadEndStack.push_back(vertex);
+                candidates.push_back(vertex);
+                --liveTriangles[vertex];
+
+                if (timeStamp - cacheTimeStamps[vertex] > CACHE_SIZE)
+                {
+                    cacheTimeStamps[vertex] = timeStamp++;
+                }
+            }
+            isEmitted[triangle] = true;
+        }
+
+        // Next fanning vertex: the candidate that stays in cache longest while still having live triangles
+        int64_t nextVertex{-1};
+        int64_t bestPriority{-1};
+        for (uint32_t vertex : candidates)
+        {
+            if (liveTriangles[vertex] == 0)
+                continue;
+
+            int64_t priority{0};
+            if (timeStamp - cacheTimeStamps[vertex] + 2 * liveTriangles[vertex] <= CACHE_SIZE)
+            {
+                priority = timeStamp - cacheTimeStamps[vertex];
+            }
+            if (priority > bestPriority)
+            {
+                bestPriority = priority;
+                nextVertex = vertex;
+            }
+        }
+
+        if (nextVertex < 0)
+        {
+            nextVertex = skipDeadEnd(vertexCursor);
+
+            // A dead end means the cache is effectively cold again, a natural place to cut an overdraw cluster
+            if (pClusterStarts != nullptr && nextVertex >= 0)
+            {
+                pClusterStarts->push_back(static_cast<uint32_t>(output.size() / 3));
+            }
+        }
+
+        fanVertex = nextVertex;
+    }
+
+    // Degenerate index counts keep their trailing indices untouched
+    output.insert(output.end(), indices.begin() + triangleCount * 3, indices.end());
+    return output;
+}
+
+std::vector<uint32_t> vmv::VMVMeshOptimizer::OptimizeOverdraw(const std::vector<uint32_t>& indices,
+                                                              const std::vector<VMVModel::Vertex>& vertices,
+                                                              const std::vector<uint32_t>& clusterStarts)
+{
+    const uint32_t triangleCount{static_cast<uint32_t>(indices.size() / 3)};
+
+    // Further split long clusters so the sort has something to work with on well connected meshes
+    std::vector<uint32_t> starts{};
+    for (size_t i{}; i < clusterStarts.size(); ++i)
+    {
+        const uint32_t end{i + 1 < clusterStarts.size() ? clusterStarts[i + 1] : triangleCount};
+        for (uint32_t start{clusterStarts[i]}; start < end; start += MAX_CLUSTER_TRIANGLES)
+        {
+            starts.push_back(start);
+        }
+    }
+
+    glm::vec3 meshCentroid{};
+    for (const VMVModel::Vertex& vertex : vertices)
+    {
+        meshCentroid += vertex.position;
+    }
+    meshCentroid /= static_cast<float>(std::max<size_t>(vertices.size(), 1));
+
+    struct Cluster
+    {
+        uint32_t start;
+        uint32_t end;
+        float sortKey;
+    };
+    std::vector<Cluster> clusters(starts.size());
+
+    for (size_t i{}; i < starts.size(); ++i)
+    {
+        Cluster& cluster{clusters[i]};
+        cluster.start = starts[i];
+        cluster.end = i + 1 < starts.size() ? starts[i + 1] : triangleCount;
+
+        glm::vec3 centroid{};
+        glm::vec3 normal{};
+        float area{};
+        for (uint32_t triangle{cluster.start}; triangle < cluster.end; ++triangle)
+        {
+            const glm::vec3& p0{vertices[indices[triangle * 3 + 0]].position};
+            const glm::vec3& p1{vertices[indices[triangle * 3 + 1]].position};
+            const glm::vec3& p2{vertices[indices[triangle * 3 + 2]].position};
+
+            const glm::vec3 areaNormal{glm::cross(p1 - p0, p2 - p0)};
+            const float triangleArea{glm::length(areaNormal)};
+
+            centroid += (p0 + p1 + p2) * (triangleArea / 3.f);
+            normal += areaNormal;
+            area += triangleArea;
+        }
+
+        if (area > 0.f)
+        {
+            centroid /= area;
+        }
+
+        // Clusters facing away from the mesh center are likely in front of the rest, draw those first
+        cluster.sortKey = glm::dot(centroid - meshCentroid, normal);
+    }
+
+    std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& a, const Cluster& b) {
+        return a.sortKey > b.sortKey;
+    });
+
+    std::vector<uint32_t> output{};
+    output.reserve(indices.size());
+    for (const Cluster& cluster : clusters)
+    {
+        output.insert(output.end(), indices.begin() + cluster.start * 3, indices.begin() + cluster.end * 3);
+    }
+    output.insert(output.end(), indices.begin() + static_cast<size_t>(triangleCount) * 3, indices.end());
+
+    return output;
+}
+
+void vmv::VMVMeshOptimizer::OptimizeVertexFetch(std::vector<VMVModel::Vertex>& vertices,
+                                                std::vector<uint32_t>& indices)
+{
+    constexpr uint32_t UNUSED{UINT32_MAX};
+
+    // Number vertices in order of first use, unreferenced vertices are dropped
+    std::vector<uint32_t> remap(vertices.size(), UNUSED);
+    std::vector<VMVModel::Vertex> reordered{};
+    reordered.reserve(vertices.size());
+
+    for (uint32_t& index : indices)
+    {
+        if (remap[index] == UNUSED)
+        {
+            remap[index] = static_cast<uint32_t>(reordered.size());
+            reordered.push_back(vertices[index]);
+        }
+        index = remap[index];
+    }
+
+    vertices = std::move(reordered);
+}
+
+vmv::VMVMeshOptimizer::CacheStats vmv::VMVMeshOptimizer::AnalyzeVertexCache(const std::vector<uint32_t>& indices,
+                                                                            size_t vertexCount)
+{
+    // FIFO cache: a vertex is a hit while fewer than CACHE_SIZE misses happened since it was last loaded
+    std::vector<uint64_t> loadedAt(vertexCount, 0);
+    uint64_t misses{};
+    size_t uniqueVertices{};
+
+    for (uint32_t index : indices)
+    {
+        if (loadedAt[index] == 0)
+        {
+            ++uniqueVertices;
+        }
+
+        if (loadedAt[index] == 0 || misses - loadedAt[index] >= CACHE_SIZE)
+        {
+            ++misses;
+            loadedAt[index] = misses;
+        }
+    }
+
+    CacheStats stats{};
+    const size_t triangleCount{indices.size() / 3};
+    stats.acmr = triangleCount > 0 ? static_cast<float>(misses) / static_cast<float>(triangleCount) : 0.f;
+    stats.atvr = uniqueVertices > 0 ? static_cast<float>(misses) / static_cast<float>(uniqueVertices) : 0.f;
+    return stats;
+}
+
+void vmv::VMVMeshOptimizer::AnalyzeMesh(const std::string& filePath)
+{
+    VMVModel::Builder builder{};
+    builder.LoadModel(filePath);
+
+    const size_t vertexCount{builder.vertices.size()};
+    std::cout << filePath << ": " << vertexCount << " vertices, " << builder.indices.size() / 3
+              << " triangles, FIFO cache of " << CACHE_SIZE << " entries\n";
+
+    const auto report{[vertexCount](const char* name, const std::vector<uint32_t>& indices, float optimizeTime) {
+        const CacheStats stats{AnalyzeVertexCache(indices, vertexCount)};
+        std::cout << "  " << name << ": ACMR " << stats.acmr << ", ATVR " << stats.atvr;
+        if (optimizeTime > 0.f)
+        {
+            std::cout << " (" << optimizeTime << "ms)";
+        }
+        std::cout << '\n';
+    }};
+    report("as loaded", builder.indices, 0.f);
+
+    using namespace std::chrono;
+    time_point start{high_resolution_clock::now()};
+    const auto elapsed{[&start]() {
+        return duration<float, milliseconds::period>(high_resolution_clock::now() - start).count();
+    }};
+
+    std::vector<uint32_t> clusterStarts{};
+    const std::vector<uint32_t> cacheOptimized{OptimizeVertexCache(builder.indices, vertexCount, &clusterStarts)};
+    report("vertex cache", cacheOptimized, elapsed());
+
+    start = high_resolution_clock::now();
+    const std::vector<uint32_t> overdrawOptimized{OptimizeOverdraw(cacheOptimized, builder.vertices, clusterStarts)};
+    report("overdraw", overdrawOptimized, elapsed());
+}
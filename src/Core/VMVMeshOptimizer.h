@@ -0,0 +1,46 @@
+#ifndef VMV_VMVMESHOPTIMIZER_H
+#define VMV_VMVMESHOPTIMIZER_H
+
+#include "VMVModel.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace vmv
+{
+    // Reorders triangle lists for the post-transform vertex cache (Tipsify, Sander et al. 2007),
+    // optionally for overdraw, and vertices for fetch locality
+    class VMVMeshOptimizer final
+    {
+      public:
+        // Typical post-transform cache size the optimizer targets and the stats simulate
+        static constexpr uint32_t CACHE_SIZE{16};
+
+        struct CacheStats
+        {
+            float acmr; // average cache miss ratio, transformed vertices per triangle (0.5 - 3)
+            float atvr; // average transform to vertex ratio, transformed vertices per unique vertex (1 is optimal)
+        };
+
+        // Runs all passes on the builder, vertex cache first since fetch order is derived from the final index order
+        static void Optimize(VMVModel::Builder& builder, bool optimizeOverdraw = false);
+
+        static std::vector<uint32_t> OptimizeVertexCache(const std::vector<uint32_t>& indices,
+                                                         size_t vertexCount,
+                                                         std::vector<uint32_t>* pClusterStarts = nullptr);
+        static std::vector<uint32_t> OptimizeOverdraw(const std::vector<uint32_t>& indices,
+                                                      const std::vector<VMVModel::Vertex>& vertices,
+                                                      const std::vector<uint32_t>& clusterStarts);
+        static void OptimizeVertexFetch(std::vector<VMVModel::Vertex>& vertices, std::vector<uint32_t>& indices);
+
+        // Simulates a FIFO cache of CACHE_SIZE entries
+        static CacheStats AnalyzeVertexCache(const std::vector<uint32_t>& indices, size_t vertexCount);
+
+        // Loads an OBJ, bypassing the mesh cache, and prints ACMR/ATVR of its triangles as loaded, after the vertex
+        // cache pass and after the overdraw pass. CPU only.
+        static void AnalyzeMesh(const std::string& filePath);
+    };
+} // namespace vmv
+
+#endif
\ No newline at end of file
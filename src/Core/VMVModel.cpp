@@ -1,99 +1,406 @@
 #include "VMVModel.h"
 
+#include "VMVMeshCache.h"
+#include "VMVMeshOptimizer.h"
 #include "VMVUtils.h"
 
 #define TINYOBJLOADER_IMPLEMENTATION
 #include <tiny_obj_loader.h>
 
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <tuple>
 #include <unordered_map>
 
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/hash.hpp>
 
-// Apparently this is the way recommended by https://en.cppreference.com/w/cpp/utility/hash
-// to specify a template specialization for std::hash
-namespace std
+namespace
 {
-    template <> struct hash<vmv::VMVModel::Vertex>
+    using Vertex = vmv::VMVModel::Vertex;
+    static_assert(sizeof(Vertex) == 11 * sizeof(float), "VertexDedupTable hashes vertices as packed floats!");
+    static_assert(sizeof(vmv::VMVModel::PackedVertex) == 20, "PackedVertex must match the packed shader inputs!");
+
+    // Flat open-addressing (linear probing) table mapping a vertex to its index in the vertex list being built.
+    // Slots only hold that index plus 32 hash bits, so a lookup touches one cache line in the common case and the
+    // vertex itself is only compared when the hash bits already match.
+    class VertexDedupTable final
     {
-        size_t operator()(const vmv::VMVModel::Vertex& vertex) const
+      public:
+        explicit VertexDedupTable(size_t maxVertexCount)
         {
-            size_t seed{0};
-            vmv::hashCombine(seed, vertex.position, vertex.color, vertex.normal, vertex.uv);
-            return seed;
+            // Sized up front for the worst case of every corner being unique, keeps the load factor below 2/3
+            size_t capacity{std::bit_ceil(std::max<size_t>(maxVertexCount + maxVertexCount / 2, 16))};
+            m_Slots.resize(capacity, Slot{EMPTY_SLOT, 0});
+            m_Mask = capacity - 1;
+        }
+
+        // Returns the index of an equal vertex in "vertices", appending the vertex first if there is none
+        uint32_t FindOrAdd(const Vertex& vertex, std::vector<Vertex>& vertices)
+        {
+            const uint64_t hash{HashVertex(vertex)};
+            const uint32_t tag{static_cast<uint32_t>(hash >> 32)};
+
+            for (size_t slotIndex{static_cast<size_t>(hash) & m_Mask};; slotIndex = (slotIndex + 1) & m_Mask)
+            {
+                Slot& slot{m_Slots[slotIndex]};
+                if (slot.index == EMPTY_SLOT)
+                {
+                    slot.index = static_cast<uint32_t>(vertices.size());
+                    slot.tag = tag;
+                    vertices.push_back(vertex);
+                    return slot.index;
+                }
+
+                if (slot.tag == tag && vertices[slot.index] == vertex)
+                {
+                    return slot.index;
+                }
+            }
+        }
+
+      private:
+        static constexpr uint32_t EMPTY_SLOT{UINT32_MAX};
+
+        struct Slot
+        {
+            uint32_t index;
+            uint32_t tag;
+        };
+
+        std::vector<Slot> m_Slots{};
+        size_t m_Mask{};
+
+        static uint64_t HashVertex(const Vertex& vertex)
+        {
+            uint32_t words[11];
+            std::memcpy(words, &vertex, sizeof(words));
+
+            uint64_t hash{0x9e3779b97f4a7c15ull};
+            for (uint32_t word : words)
+            {
+                // -0.0f == 0.0f for Vertex::operator==, so both have to hash the same
+                word = word == 0x80000000u ? 0u : word;
+                hash = (hash ^ word) * 0xff51afd7ed558ccdull;
+                hash ^= hash >> 32;
+            }
+            return hash;
         }
     };
-} // namespace std
 
-vmv::VMVModel::VMVModel(VMVDevice& device, const Builder& builder) : m_VMVDevice{device}
+    // side x side grid with positions, normals and uvs, written as OBJ so it goes through the same parser
+    std::string WriteBenchmarkObj(uint32_t side)
+    {
+        const std::string filePath{(std::filesystem::temp_directory_path() / "vmv_benchmark_loader.obj").string()};
+        std::ofstream file{filePath, std::ios::trunc};
+        if (!file.is_open())
+        {
+            throw std::runtime_error{"Failed to write benchmark OBJ: " + filePath};
+        }
+
+        for (uint32_t y{}; y < side; ++y)
+        {
+            for (uint32_t x{}; x < side; ++x)
+            {
+                const float u{static_cast<float>(x) / (side - 1)};
+                const float v{static_cast<float>(y) / (side - 1)};
+                file << "v " << u << ' ' << std::sin(u * 6.f) * std::cos(v * 6.f) * .1f << ' ' << v << '\n';
+                file << "vn 0 1 0\nvt " << u << ' ' << v << '\n';
+            }
+        }
+        for (uint32_t y{}; y + 1 < side; ++y)
+        {
+            for (uint32_t x{}; x + 1 < side; ++x)
+            {
+                // OBJ indices are 1-based, the same index for position, uv and normal
+                const uint32_t i0{y * side + x + 1};
+                const uint32_t i1{i0 + 1};
+                const uint32_t i2{i0 + side};
+                const uint32_t i3{i2 + 1};
+                file << "f " << i0 << '/' << i0 << '/' << i0 << ' ' << i2 << '/' << i2 << '/' << i2 << ' ' << i1 << '/'
+                     << i1 << '/' << i1 << '\n';
+                file << "f " << i1 << '/' << i1 << '/' << i1 << ' ' << i2 << '/' << i2 << '/' << i2 << ' ' << i3 << '/'
+                     << i3 << '/' << i3 << '\n';
+            }
+        }
+        return filePath;
+    }
+} // namespace
+
+vmv::VMVModel::VMVModel(VMVDevice& device, const Builder& builder, VMVUploadBatch* pUploadBatch)
+    : m_VMVDevice{device}, m_VertexFormat{builder.vertexFormat}
 {
-    CreateVertexBuffers(builder.vertices);
-    CreateIndexBuffers(builder.indices);
+    std::unique_ptr<VMVUploadBatch> ownUploadBatch{};
+    if (pUploadBatch == nullptr)
+    {
+        ownUploadBatch = std::make_unique<VMVUploadBatch>(device);
+        pUploadBatch = ownUploadBatch.get();
+    }
+
+    CalculateBounds(builder.vertices);
+
+    if (builder.splitSubmeshes && builder.vertices.size() > MAX_UINT16_VERTICES && !builder.indices.empty())
+    {
+        std::vector<Vertex> splitVertices{};
+        std::vector<uint32_t> splitIndices{};
+        m_Submeshes = SplitSubmeshes(builder, splitVertices, splitIndices);
+        m_IndexType = VK_INDEX_TYPE_UINT16;
+
+        CreateVertexBuffers(splitVertices, *pUploadBatch);
+        CreateIndexBuffers(splitIndices, *pUploadBatch);
+        return;
+    }
+
+    if (!builder.indices.empty())
+    {
+        m_Submeshes.push_back({0, static_cast<uint32_t>(builder.indices.size()), 0});
+        m_IndexType = builder.vertices.size() <= MAX_UINT16_VERTICES ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+    }
+
+    CreateVertexBuffers(builder.vertices, *pUploadBatch);
+    CreateIndexBuffers(builder.indices, *pUploadBatch);
 }
 
-vmv::VMVModel::~VMVModel() {}
+vmv::VMVModel::~VMVModel()
+{
+    m_VMVDevice.getGeometryPool().Free(m_VertexRange);
+    m_VMVDevice.getGeometryPool().Free(m_IndexRange);
+}
 
-std::unique_ptr<vmv::VMVModel> vmv::VMVModel::CreateModelFromFile(VMVDevice& device, const std::string& filePath)
+std::unique_ptr<vmv::VMVModel> vmv::VMVModel::CreateModelFromFile(VMVDevice& device,
+                                                                  const std::string& filePath,
+                                                                  VertexFormat vertexFormat,
+                                                                  bool splitSubmeshes,
+                                                                  VMVUploadBatch* pUploadBatch)
 {
+    using namespace std::chrono;
+    const time_point start{high_resolution_clock::now()};
+
     Builder builder{};
-    builder.LoadModel(filePath);
+    builder.vertexFormat = vertexFormat;
+    builder.splitSubmeshes = splitSubmeshes;
+    const bool isCached{VMVMeshCache::Load(filePath, builder)};
+    if (!isCached)
+    {
+        builder.LoadModel(filePath);
+
+        const VMVMeshOptimizer::CacheStats before{
+            VMVMeshOptimizer::AnalyzeVertexCache(builder.indices, builder.vertices.size())};
+        VMVMeshOptimizer::Optimize(builder);
+        const VMVMeshOptimizer::CacheStats after{
+            VMVMeshOptimizer::AnalyzeVertexCache(builder.indices, builder.vertices.size())};
+        std::cout << "Optimized " << filePath << ": ACMR " << before.acmr << " -> " << after.acmr << ", ATVR "
+                  << before.atvr << " -> " << after.atvr << '\n';
+
+        VMVMeshCache::Save(filePath, builder);
+    }
+
+    std::unique_ptr<VMVModel> model{std::make_unique<VMVModel>(device, builder, pUploadBatch)};
 
-    return std::make_unique<VMVModel>(device, builder);
+    const float loadTime{duration<float, milliseconds::period>(high_resolution_clock::now() - start).count()};
+    const Stats stats{model->GetStats()};
+    std::cout << "Loaded " << filePath << (isCached ? " from mesh cache" : " from OBJ") << " in " << loadTime
+              << "ms (" << stats.vertexCount << " vertices at " << stats.vertexSize << " bytes, " << stats.indexCount
+              << " indices at " << stats.indexSize << " bytes in " << stats.submeshCount << " submeshes, "
+              << stats.indexBytesSaved << " index bytes saved)\n";
+
+    return model;
+}
+
+uint32_t vmv::VMVModel::GetVertexSize(VertexFormat vertexFormat)
+{
+    return vertexFormat == VertexFormat::Packed ? sizeof(PackedVertex) : sizeof(Vertex);
+}
+
+glm::mat4 vmv::VMVModel::GetDequantizeMatrix() const
+{
+    if (m_VertexFormat != VertexFormat::Packed)
+        return glm::mat4{1.f};
+
+    const glm::vec3 extent{m_BoundsMax - m_BoundsMin};
+    return glm::mat4{{extent.x, 0.f, 0.f, 0.f},
+                     {0.f, extent.y, 0.f, 0.f},
+                     {0.f, 0.f, extent.z, 0.f},
+                     {m_BoundsMin.x, m_BoundsMin.y, m_BoundsMin.z, 1.f}};
 }
 
-void vmv::VMVModel::Bind(VkCommandBuffer commandBuffer)
+glm::vec4 vmv::VMVModel::GetVertexBoundingSphere() const
 {
-    VkBuffer buffers[] = {m_VertexBuffer->getBuffer()};
-    VkDeviceSize offsets[] = {0};
-    vkCmdBindVertexBuffers(commandBuffer, 0, 1, buffers, offsets);
+    // The dequantize matrix scales each axis separately, the sphere around the unit cube stays conservative
+    if (m_VertexFormat == VertexFormat::Packed)
+        return glm::vec4{.5f, .5f, .5f, std::sqrt(3.f) * .5f};
+
+    return m_BoundingSphere;
+}
+
+vmv::VMVModel::Stats vmv::VMVModel::GetStats() const
+{
+    Stats stats{};
+    stats.vertexCount = m_VertexCount;
+    stats.indexCount = m_HasIndexBuffer ? m_IndexCount : 0;
+    stats.submeshCount = static_cast<uint32_t>(m_Submeshes.size());
+    stats.vertexSize = GetVertexSize(m_VertexFormat);
+    stats.indexSize = m_IndexType == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
+    stats.vertexBufferSize = static_cast<VkDeviceSize>(stats.vertexSize) * stats.vertexCount;
+    stats.indexBufferSize = static_cast<VkDeviceSize>(stats.indexSize) * stats.indexCount;
+    stats.indexBytesSaved = static_cast<VkDeviceSize>(sizeof(uint32_t)) * stats.indexCount - stats.indexBufferSize;
+    return stats;
+}
+
+void vmv::VMVModel::Bind(VMVCommandState& commandState) const
+{
+    commandState.BindVertexBuffer(m_VertexRange.buffer, 0);
 
     if (m_HasIndexBuffer)
     {
-        vkCmdBindIndexBuffer(commandBuffer, m_IndexBuffer->getBuffer(), 0, VK_INDEX_TYPE_UINT32);
+        commandState.BindIndexBuffer(m_IndexRange.buffer, 0, m_IndexType);
     }
 }
 
-void vmv::VMVModel::Draw(VkCommandBuffer commandBuffer)
+void vmv::VMVModel::Draw(VkCommandBuffer commandBuffer, uint32_t instanceCount, uint32_t firstInstance) const
 {
     if (m_HasIndexBuffer)
     {
-        vkCmdDrawIndexed(commandBuffer, m_IndexCount, 1, 0, 0, 0);
+        for (const Submesh& submesh : m_Submeshes)
+        {
+            vkCmdDrawIndexed(commandBuffer,
+                             submesh.indexCount,
+                             instanceCount,
+                             m_IndexRange.firstElement + submesh.firstIndex,
+                             static_cast<int32_t>(m_VertexRange.firstElement) + submesh.vertexOffset,
+                             firstInstance);
+        }
     }
     else
     {
-        vkCmdDraw(commandBuffer, m_VertexCount, 1, 0, 0);
+        vkCmdDraw(commandBuffer, m_VertexCount, instanceCount, m_VertexRange.firstElement, firstInstance);
+    }
+}
+
+uint32_t vmv::VMVModel::WriteIndirectCommands(VkDrawIndexedIndirectCommand* pCommands,
+                                              uint32_t instanceCount,
+                                              uint32_t firstInstance) const
+{
+    if (!m_HasIndexBuffer)
+        return 0;
+
+    for (const Submesh& submesh : m_Submeshes)
+    {
+        VkDrawIndexedIndirectCommand& command{*pCommands++};
+        command.indexCount = submesh.indexCount;
+        command.instanceCount = instanceCount;
+        command.firstIndex = m_IndexRange.firstElement + submesh.firstIndex;
+        command.vertexOffset = static_cast<int32_t>(m_VertexRange.firstElement) + submesh.vertexOffset;
+        command.firstInstance = firstInstance;
+    }
+    return static_cast<uint32_t>(m_Submeshes.size());
+}
+
+bool vmv::VMVModel::SharesBuffersWith(const VMVModel& other) const
+{
+    if (m_VertexRange.buffer != other.m_VertexRange.buffer)
+        return false;
+
+    return !m_HasIndexBuffer || (m_IndexRange.buffer == other.m_IndexRange.buffer && m_IndexType == other.m_IndexType);
+}
+
+void vmv::VMVModel::CalculateBounds(const std::vector<Vertex>& vertices)
+{
+    if (vertices.empty())
+        return;
+
+    m_BoundsMin = vertices[0].position;
+    m_BoundsMax = vertices[0].position;
+    for (const Vertex& vertex : vertices)
+    {
+        m_BoundsMin = glm::min(m_BoundsMin, vertex.position);
+        m_BoundsMax = glm::max(m_BoundsMax, vertex.position);
+    }
+
+    // Tighter than the AABB's circumsphere for most meshes, no vertex sits in every corner
+    const glm::vec3 center{(m_BoundsMin + m_BoundsMax) * .5f};
+    float radiusSquared{};
+    for (const Vertex& vertex : vertices)
+    {
+        const glm::vec3 offset{vertex.position - center};
+        radiusSquared = std::max(radiusSquared, glm::dot(offset, offset));
     }
+    m_BoundingSphere = glm::vec4{center, std::sqrt(radiusSquared)};
 }
 
-void vmv::VMVModel::CreateVertexBuffers(const std::vector<Vertex>& vertices)
+void vmv::VMVModel::CreateVertexBuffers(const std::vector<Vertex>& vertices, VMVUploadBatch& uploadBatch)
 {
     m_VertexCount = static_cast<uint32_t>(vertices.size());
     assert(m_VertexCount >= 3 && "Model has less than 3 indices!");
 
-    VkDeviceSize bufferSize{sizeof(vertices[0]) * m_VertexCount};
-    uint32_t vertexSize{sizeof(vertices[0])};
+    std::vector<PackedVertex> packedVertices{};
+    const void* vertexData{vertices.data()};
+    if (m_VertexFormat == VertexFormat::Packed)
+    {
+        packedVertices = PackVertices(vertices);
+        vertexData = packedVertices.data();
+    }
 
-    VMVBuffer stagingBuffer{
-        m_VMVDevice,
-        vertexSize,
-        m_VertexCount,
-        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-    };
+    uint32_t vertexSize{GetVertexSize(m_VertexFormat)};
+    VkDeviceSize bufferSize{static_cast<VkDeviceSize>(vertexSize) * m_VertexCount};
 
-    stagingBuffer.map();
-    stagingBuffer.writeToBuffer((void*)vertices.data());
+    m_VertexRange =
+        m_VMVDevice.getGeometryPool().Allocate(VMVGeometryPool::BufferType::Vertex, vertexSize, m_VertexCount);
+    uploadBatch.Upload(m_VertexRange.buffer, vertexData, bufferSize, m_VertexRange.GetByteOffset());
+}
 
-    m_VertexBuffer = std::make_unique<VMVBuffer>(m_VMVDevice,
-                                                 vertexSize,
-                                                 m_VertexCount,
-                                                 VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-                                                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+std::vector<vmv::VMVModel::PackedVertex> vmv::VMVModel::PackVertices(const std::vector<Vertex>& vertices) const
+{
+    const glm::vec3 extent{m_BoundsMax - m_BoundsMin};
+    const glm::vec3 invExtent{extent.x > 0.f ? 1.f / extent.x : 0.f,
+                              extent.y > 0.f ? 1.f / extent.y : 0.f,
+                              extent.z > 0.f ? 1.f / extent.z : 0.f};
 
-    m_VMVDevice.copyBuffer(stagingBuffer.getBuffer(), m_VertexBuffer->getBuffer(), bufferSize);
+    std::vector<PackedVertex> packedVertices(vertices.size());
+    for (size_t i{}; i < vertices.size(); ++i)
+    {
+        const Vertex& vertex{vertices[i]};
+        PackedVertex& packed{packedVertices[i]};
+
+        const glm::vec3 position{glm::round(glm::clamp((vertex.position - m_BoundsMin) * invExtent, 0.f, 1.f) *
+                                            65535.f)};
+        packed.position[0] = static_cast<uint16_t>(position.x);
+        packed.position[1] = static_cast<uint16_t>(position.y);
+        packed.position[2] = static_cast<uint16_t>(position.z);
+
+        // Octahedral encoding: project onto the octahedron |x| + |y| + |z| = 1 and fold the lower half over
+        glm::vec3 normal{vertex.normal};
+        const float l1Norm{glm::abs(normal.x) + glm::abs(normal.y) + glm::abs(normal.z)};
+        glm::vec2 octahedral{};
+        if (l1Norm > 0.f)
+        {
+            normal /= l1Norm;
+            octahedral = {normal.x, normal.y};
+            if (normal.z < 0.f)
+            {
+                octahedral = {(1.f - glm::abs(normal.y)) * (normal.x >= 0.f ? 1.f : -1.f),
+                              (1.f - glm::abs(normal.x)) * (normal.y >= 0.f ? 1.f : -1.f)};
+            }
+        }
+        packed.normal = glm::packSnorm2x16(octahedral);
+
+        packed.color = glm::packUnorm4x8(glm::vec4{vertex.color, 1.f});
+        packed.uv = glm::packHalf2x16(vertex.uv);
+    }
+
+    return packedVertices;
 }
 
-void vmv::VMVModel::CreateIndexBuffers(const std::vector<uint32_t>& indices)
+void vmv::VMVModel::CreateIndexBuffers(const std::vector<uint32_t>& indices, VMVUploadBatch& uploadBatch)
 {
     m_IndexCount = static_cast<uint32_t>(indices.size());
     m_HasIndexBuffer = m_IndexCount > 0;
@@ -101,27 +408,77 @@ void vmv::VMVModel::CreateIndexBuffers(const std::vector<uint32_t>& indices)
     if (!m_HasIndexBuffer)
         return;
 
-    VkDeviceSize bufferSize{sizeof(indices[0]) * m_IndexCount};
-    uint32_t indexSize{sizeof(indices[0])};
+    // Narrowed copy for 16-bit indices, submesh indices are already local to their vertexOffset
+    std::vector<uint16_t> indices16{};
+    const void* indexData{indices.data()};
+    if (m_IndexType == VK_INDEX_TYPE_UINT16)
+    {
+        indices16.resize(indices.size());
+        std::transform(indices.begin(), indices.end(), indices16.begin(), [](uint32_t index) {
+            return static_cast<uint16_t>(index);
+        });
+        indexData = indices16.data();
+    }
 
-    VMVBuffer stagingBuffer{
-        m_VMVDevice,
-        indexSize,
-        m_IndexCount,
-        VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-    };
+    uint32_t indexSize{
+        static_cast<uint32_t>(m_IndexType == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t))};
+    VkDeviceSize bufferSize{static_cast<VkDeviceSize>(indexSize) * m_IndexCount};
+
+    m_IndexRange = m_VMVDevice.getGeometryPool().Allocate(VMVGeometryPool::BufferType::Index, indexSize, m_IndexCount);
+    uploadBatch.Upload(m_IndexRange.buffer, indexData, bufferSize, m_IndexRange.GetByteOffset());
+}
+
+std::vector<vmv::VMVModel::Submesh> vmv::VMVModel::SplitSubmeshes(const Builder& builder,
+                                                                  std::vector<Vertex>& outVertices,
+                                                                  std::vector<uint32_t>& outIndices)
+{
+    constexpr uint32_t NONE{UINT32_MAX};
+
+    // Greedy in index order, which after vertex cache optimization keeps submeshes spatially coherent.
+    // Vertices shared across a split are duplicated into both submeshes.
+    std::vector<uint32_t> vertexSubmesh(builder.vertices.size(), NONE);
+    std::vector<uint32_t> localIndex(builder.vertices.size(), NONE);
+    std::vector<Submesh> submeshes{};
 
-    stagingBuffer.map();
-    stagingBuffer.writeToBuffer((void*)indices.data());
+    outVertices.clear();
+    outIndices.clear();
+    outIndices.reserve(builder.indices.size());
 
-    m_IndexBuffer = std::make_unique<VMVBuffer>(m_VMVDevice,
-                                                indexSize,
-                                                m_IndexCount,
-                                                VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-                                                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    uint32_t submeshIndex{};
+    uint32_t localVertexCount{};
+    submeshes.push_back({});
+
+    for (size_t triangle{}; triangle + 2 < builder.indices.size(); triangle += 3)
+    {
+        uint32_t newVertexCount{};
+        for (size_t corner{}; corner < 3; ++corner)
+        {
+            newVertexCount += vertexSubmesh[builder.indices[triangle + corner]] != submeshIndex ? 1 : 0;
+        }
+
+        if (localVertexCount + newVertexCount > MAX_UINT16_VERTICES)
+        {
+            ++submeshIndex;
+            localVertexCount = 0;
+            submeshes.push_back(
+                {static_cast<uint32_t>(outIndices.size()), 0, static_cast<int32_t>(outVertices.size())});
+        }
 
-    m_VMVDevice.copyBuffer(stagingBuffer.getBuffer(), m_IndexBuffer->getBuffer(), bufferSize);
+        for (size_t corner{}; corner < 3; ++corner)
+        {
+            const uint32_t vertex{builder.indices[triangle + corner]};
+            if (vertexSubmesh[vertex] != submeshIndex)
+            {
+                vertexSubmesh[vertex] = submeshIndex;
+                localIndex[vertex] = localVertexCount++;
+                outVertices.push_back(builder.vertices[vertex]);
+            }
+            outIndices.push_back(localIndex[vertex]);
+        }
+        submeshes.back().indexCount += 3;
+    }
+
+    return submeshes;
 }
 
 std::vector<VkVertexInputBindingDescription> vmv::VMVModel::Vertex::GetBindingDescriptions()
@@ -151,7 +508,35 @@ std::vector<VkVertexInputAttributeDescription> vmv::VMVModel::Vertex::GetAttribu
     return attributeDescriptions;
 }
 
-void vmv::VMVModel::Builder::LoadModel(const std::string& filePath)
+std::vector<VkVertexInputBindingDescription> vmv::VMVModel::PackedVertex::GetBindingDescriptions()
+{
+    std::vector<VkVertexInputBindingDescription> bindingDescriptions(1);
+    bindingDescriptions[0].binding = 0;
+    bindingDescriptions[0].stride = sizeof(PackedVertex);
+    bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+    return bindingDescriptions;
+}
+
+std::vector<VkVertexInputAttributeDescription> vmv::VMVModel::PackedVertex::GetAttributeDescriptions()
+{
+    std::vector<VkVertexInputAttributeDescription> attributeDescriptions{};
+
+    attributeDescriptions.push_back(
+        {0, 0, VK_FORMAT_R16G16B16A16_UNORM, static_cast<uint32_t>(offsetof(PackedVertex, position))});
+
+    attributeDescriptions.push_back(
+        {1, 0, VK_FORMAT_R8G8B8A8_UNORM, static_cast<uint32_t>(offsetof(PackedVertex, color))});
+
+    attributeDescriptions.push_back(
+        {2, 0, VK_FORMAT_R16G16_SNORM, static_cast<uint32_t>(offsetof(PackedVertex, normal))});
+
+    attributeDescriptions.push_back({3, 0, VK_FORMAT_R16G16_SFLOAT, static_cast<uint32_t>(offsetof(PackedVertex, uv))});
+
+    return attributeDescriptions;
+}
+
+void vmv::VMVModel::Builder::LoadModel(const std::string& filePath, uint32_t threadCount)
 {
     using namespace tinyobj;
     attrib_t attrib;
@@ -167,49 +552,278 @@ void vmv::VMVModel::Builder::LoadModel(const std::string& filePath)
     vertices.clear();
     indices.clear();
 
-    std::unordered_map<Vertex, uint32_t> uniqueVertices{};
+    // Global corner offset of every shape, so the index space can be split independent of shape boundaries
+    std::vector<size_t> shapeOffsets(shapes.size() + 1);
+    for (size_t i{}; i < shapes.size(); ++i)
+    {
+        shapeOffsets[i + 1] = shapeOffsets[i] + shapes[i].mesh.indices.size();
+    }
+    const size_t cornerCount{shapeOffsets.back()};
+
+    if (threadCount == 0)
+    {
+        threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    threadCount = static_cast<uint32_t>(
+        std::clamp<size_t>(cornerCount / MIN_CORNERS_PER_THREAD, 1, static_cast<size_t>(threadCount)));
+
+    if (threadCount == 1)
+    {
+        DeduplicateCorners(attrib, shapes, shapeOffsets, 0, cornerCount, vertices, indices);
+        return;
+    }
+
+    // Every chunk deduplicates its own range of corners into a local vertex list...
+    struct Chunk
+    {
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+        std::vector<uint32_t> remap;
+    };
+    std::vector<Chunk> chunks(threadCount);
+    const size_t chunkSize{(cornerCount + threadCount - 1) / threadCount};
+
+    const auto runChunks{[&](auto&& work) {
+        std::vector<std::thread> threads{};
+        threads.reserve(threadCount);
+        for (uint32_t i{}; i < threadCount; ++i)
+        {
+            const size_t begin{std::min(i * chunkSize, cornerCount)};
+            const size_t end{std::min(begin + chunkSize, cornerCount)};
+            threads.emplace_back(work, i, begin, end);
+        }
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+    }};
+
+    runChunks([&](uint32_t chunkIndex, size_t begin, size_t end) {
+        Chunk& chunk{chunks[chunkIndex]};
+        DeduplicateCorners(attrib, shapes, shapeOffsets, begin, end, chunk.vertices, chunk.indices);
+    });
+
+    // ...then the local lists are merged in chunk order. A vertex first seen in chunk N gets its global index when
+    // chunk N is merged, in local first-use order, which is exactly the order the serial path would have assigned.
+    size_t chunkVertexCount{};
+    for (const Chunk& chunk : chunks)
+    {
+        chunkVertexCount += chunk.vertices.size();
+    }
+
+    VertexDedupTable uniqueVertices{chunkVertexCount};
+    for (Chunk& chunk : chunks)
+    {
+        chunk.remap.resize(chunk.vertices.size());
+        for (size_t i{}; i < chunk.vertices.size(); ++i)
+        {
+            chunk.remap[i] = uniqueVertices.FindOrAdd(chunk.vertices[i], vertices);
+        }
+    }
+
+    indices.resize(cornerCount);
+    runChunks([&](uint32_t chunkIndex, size_t begin, size_t) {
+        const Chunk& chunk{chunks[chunkIndex]};
+        for (size_t i{}; i < chunk.indices.size(); ++i)
+        {
+            indices[begin + i] = chunk.remap[chunk.indices[i]];
+        }
+    });
+}
+
+void vmv::VMVModel::Builder::DeduplicateCorners(const tinyobj::attrib_t& attrib,
+                                                const std::vector<tinyobj::shape_t>& shapes,
+                                                const std::vector<size_t>& shapeOffsets,
+                                                size_t begin,
+                                                size_t end,
+                                                std::vector<Vertex>& outVertices,
+                                                std::vector<uint32_t>& outIndices)
+{
+    using namespace tinyobj;
+
+    VertexDedupTable uniqueVertices{end - begin};
+    outIndices.reserve(end - begin);
+
+    // First shape that contains corner "begin"
+    size_t shapeIndex{static_cast<size_t>(
+        std::upper_bound(shapeOffsets.begin(), shapeOffsets.end(), begin) - shapeOffsets.begin() - 1)};
+
+    for (size_t corner{begin}; corner < end; ++corner)
+    {
+        while (corner >= shapeOffsets[shapeIndex + 1])
+        {
+            ++shapeIndex;
+        }
+        const index_t& index{shapes[shapeIndex].mesh.indices[corner - shapeOffsets[shapeIndex]]};
+
+        Vertex vertex{};
+
+        if (index.vertex_index >= 0)
+        {
+            vertex.position = {
+                attrib.vertices[3 * index.vertex_index + 0],
+                attrib.vertices[3 * index.vertex_index + 1],
+                attrib.vertices[3 * index.vertex_index + 2],
+            };
+
+            vertex.color = {
+                attrib.colors[3 * index.vertex_index + 0],
+                attrib.colors[3 * index.vertex_index + 1],
+                attrib.colors[3 * index.vertex_index + 2],
+            };
+        }
+        if (index.normal_index >= 0)
+        {
+            vertex.normal = {
+                attrib.normals[3 * index.normal_index + 0],
+                attrib.normals[3 * index.normal_index + 1],
+                attrib.normals[3 * index.normal_index + 2],
+            };
+        }
+        if (index.texcoord_index >= 0)
+        {
+            vertex.uv = {attrib.texcoords[2 * index.texcoord_index + 0],
+                         attrib.texcoords[2 * index.texcoord_index + 1]};
+        }
+
+        outIndices.push_back(uniqueVertices.FindOrAdd(vertex, outVertices));
+    }
+}
+
+void vmv::VMVModel::Builder::RunBenchmark(const std::string& filePath)
+{
+    constexpr uint32_t ITERATIONS{3};
+    constexpr uint32_t GRID_SIDE{512};
+
+    const bool isGenerated{filePath.empty()};
+    const std::string benchmarkPath{isGenerated ? WriteBenchmarkObj(GRID_SIDE) : filePath};
+
+    // Best of a few loads, the first one also pulls the file into the page cache
+    const auto measure{[&benchmarkPath](uint32_t threadCount, Builder& builder) {
+        using namespace std::chrono;
+        float bestTime{};
+        for (uint32_t i{}; i < ITERATIONS; ++i)
+        {
+            const time_point start{high_resolution_clock::now()};
+            builder.LoadModel(benchmarkPath, threadCount);
+            const float time{duration<float, milliseconds::period>(high_resolution_clock::now() - start).count()};
+            bestTime = i == 0 ? time : std::min(bestTime, time);
+        }
+        return bestTime;
+    }};
+
+    Builder serial{};
+    const float serialTime{measure(1, serial)};
+    std::cout << "Loader benchmark: " << benchmarkPath << ", " << serial.indices.size() << " corners, "
+              << serial.vertices.size() << " unique vertices, 1 thread: " << serialTime << "ms\n";
+
+    const uint32_t maxThreadCount{std::max(std::thread::hardware_concurrency(), 1u)};
+    for (uint32_t threadCount{2}; threadCount <= maxThreadCount; threadCount *= 2)
+    {
+        // The merge keeps first-use order, so every thread count has to produce the serial result exactly
+        Builder parallel{};
+        const float parallelTime{measure(threadCount, parallel)};
+        const bool isSame{parallel.vertices == serial.vertices && parallel.indices == serial.indices};
+        std::cout << "Loader benchmark: " << threadCount << " threads: " << parallelTime << "ms ("
+                  << serialTime / parallelTime << "x one thread)" << (isSame ? "" : ", RESULTS DIFFER") << '\n';
+    }
 
-    for (const shape_t& shape : shapes)
+    if (isGenerated)
     {
-        for (const index_t& index : shape.mesh.indices)
+        std::error_code error{};
+        std::filesystem::remove(benchmarkPath, error);
+    }
+}
+
+void vmv::VMVModel::Builder::RunDedupBenchmark(size_t cornerCount)
+{
+    constexpr uint32_t ITERATIONS{5};
+
+    // Corners of a grid mesh in triangle order, most vertices are shared by six corners like in a closed mesh.
+    // Shuffled triangles, so neither container sees the vertices in the order they were created.
+    const uint32_t side{static_cast<uint32_t>(std::sqrt(static_cast<double>(cornerCount) / 6.0)) + 2};
+    std::vector<std::array<uint32_t, 3>> triangles{};
+    for (uint32_t y{}; y + 1 < side; ++y)
+    {
+        for (uint32_t x{}; x + 1 < side; ++x)
+        {
+            const uint32_t i0{y * side + x};
+            triangles.push_back({i0, i0 + side, i0 + 1});
+            triangles.push_back({i0 + 1, i0 + side, i0 + side + 1});
+        }
+    }
+    std::mt19937 random{42};
+    std::shuffle(triangles.begin(), triangles.end(), random);
+
+    std::vector<Vertex> corners{};
+    corners.reserve(cornerCount);
+    for (size_t i{}; corners.size() < cornerCount; ++i)
+    {
+        for (uint32_t index : triangles[i % triangles.size()])
         {
             Vertex vertex{};
+            vertex.position = {static_cast<float>(index % side), 0.f, static_cast<float>(index / side)};
+            vertex.normal = {0.f, 1.f, 0.f};
+            vertex.uv = {vertex.position.x / side, vertex.position.z / side};
+            corners.push_back(vertex);
+        }
+    }
+    corners.resize(cornerCount);
 
-            if (index.vertex_index >= 0)
-            {
-                vertex.position = {
-                    attrib.vertices[3 * index.vertex_index + 0],
-                    attrib.vertices[3 * index.vertex_index + 1],
-                    attrib.vertices[3 * index.vertex_index + 2],
-                };
-
-                vertex.color = {
-                    attrib.colors[3 * index.vertex_index + 0],
-                    attrib.colors[3 * index.vertex_index + 1],
-                    attrib.colors[3 * index.vertex_index + 2],
-                };
-            }
-            if (index.normal_index >= 0)
-            {
-                vertex.normal = {
-                    attrib.normals[3 * index.normal_index + 0],
-                    attrib.normals[3 * index.normal_index + 1],
-                    attrib.normals[3 * index.normal_index + 2],
-                };
-            }
-            if (index.texcoord_index >= 0)
+    // The std::hash<Vertex> the loader had before VertexDedupTable
+    struct VertexHash
+    {
+        size_t operator()(const Vertex& vertex) const
+        {
+            size_t seed{0};
+            hashCombine(seed, vertex.position, vertex.color, vertex.normal, vertex.uv);
+            return seed;
+        }
+    };
+
+    const auto measure{[&corners](auto&& deduplicate) {
+        std::vector<Vertex> vertices{};
+        std::vector<uint32_t> indices{};
+        using namespace std::chrono;
+        float bestTime{};
+        for (uint32_t i{}; i < ITERATIONS; ++i)
+        {
+            vertices.clear();
+            indices.clear();
+            indices.reserve(corners.size());
+            const time_point start{high_resolution_clock::now()};
+            deduplicate(vertices, indices);
+            const float time{duration<float, milliseconds::period>(high_resolution_clock::now() - start).count()};
+            bestTime = i == 0 ? time : std::min(bestTime, time);
+        }
+        return std::tuple{bestTime, std::move(vertices), std::move(indices)};
+    }};
+
+    const auto [tableTime, tableVertices, tableIndices]{
+        measure([&corners](std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) {
+            VertexDedupTable uniqueVertices{corners.size()};
+            for (const Vertex& corner : corners)
             {
-                vertex.uv = {attrib.texcoords[2 * index.texcoord_index + 0],
-                             attrib.texcoords[2 * index.texcoord_index + 1]};
+                indices.push_back(uniqueVertices.FindOrAdd(corner, vertices));
             }
+        })};
 
-            if (uniqueVertices.count(vertex) == 0)
+    const auto [mapTime, mapVertices, mapIndices]{
+        measure([&corners](std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) {
+            std::unordered_map<Vertex, uint32_t, VertexHash> uniqueVertices{};
+            for (const Vertex& corner : corners)
             {
-                uniqueVertices[vertex] = static_cast<uint32_t>(vertices.size());
-                vertices.push_back(vertex);
+                const auto [it, isInserted]{uniqueVertices.try_emplace(corner, static_cast<uint32_t>(vertices.size()))};
+                if (isInserted)
+                {
+                    vertices.push_back(corner);
+                }
+                indices.push_back(it->second);
             }
+        })};
 
-            indices.push_back(uniqueVertices[vertex]);
-        }
-    }
+    const bool isSame{tableVertices == mapVertices && tableIndices == mapIndices};
+    std::cout << "Dedup benchmark: " << cornerCount << " corners, " << tableVertices.size()
+              << " unique vertices, std::unordered_map " << mapTime << "ms, VertexDedupTable " << tableTime << "ms ("
+              << mapTime / tableTime << "x)" << (isSame ? "" : ", RESULTS DIFFER") << '\n';
 }
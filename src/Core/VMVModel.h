@@ -2,17 +2,34 @@
 #define VMV_VMVMODEL_H
 
 #include "VMVBuffer.h"
+#include "VMVCommandState.h"
 #include "VMVDevice.h"
+#include "VMVGeometryPool.h"
+#include "VMVUploadBatch.h"
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #include <glm/glm.hpp>
 #include <memory>
+#include <string>
+#include <vector>
+
+namespace tinyobj
+{
+    struct attrib_t;
+    struct shape_t;
+} // namespace tinyobj
 
 namespace vmv
 {
     class VMVModel final
     {
       public:
+        enum class VertexFormat
+        {
+            Full,  // Vertex, 44 bytes
+            Packed // PackedVertex, 20 bytes
+        };
+
         struct Vertex
         {
             glm::vec3 position{};
@@ -29,15 +46,80 @@ namespace vmv
             }
         };
 
+        // Quantized layout: position as 16-bit unorm relative to the mesh AABB, octahedral normal as 2x16-bit snorm,
+        // 8-bit color and half-float uv. Decoded by the *_packed.vert shaders, see GetDequantizeMatrix()
+        struct PackedVertex
+        {
+            uint16_t position[4]{};
+            uint32_t normal{};
+            uint32_t color{};
+            uint32_t uv{};
+
+            static std::vector<VkVertexInputBindingDescription> GetBindingDescriptions();
+            static std::vector<VkVertexInputAttributeDescription> GetAttributeDescriptions();
+        };
+
         struct Builder
         {
             std::vector<Vertex> vertices{};
             std::vector<uint32_t> indices{};
 
-            void LoadModel(const std::string& filePath);
+            // Layout the vertices are uploaded in, the builder itself always holds full vertices
+            VertexFormat vertexFormat{VertexFormat::Full};
+
+            // Meshes with more vertices than 16-bit indices can address are split into submeshes that fit,
+            // otherwise they fall back to 32-bit indices
+            bool splitSubmeshes{false};
+
+            // threadCount 0 picks one thread per hardware thread; small meshes always deduplicate serially
+            void LoadModel(const std::string& filePath, uint32_t threadCount = 0);
+
+            // Loads filePath with 1, 2, 4... up to one thread per hardware thread and reports the parse and
+            // dedup time of each against the single threaded one. Without a path a generated grid OBJ of a few
+            // million corners is used. CPU only.
+            static void RunBenchmark(const std::string& filePath = "");
+
+            // Deduplicates the corners of a generated grid mesh with the flat VertexDedupTable and with the
+            // std::unordered_map the loader used before, and reports both times. CPU only.
+            static void RunDedupBenchmark(size_t cornerCount);
+
+          private:
+            static constexpr size_t MIN_CORNERS_PER_THREAD{1 << 16};
+
+            static void DeduplicateCorners(const tinyobj::attrib_t& attrib,
+                                           const std::vector<tinyobj::shape_t>& shapes,
+                                           const std::vector<size_t>& shapeOffsets,
+                                           size_t begin,
+                                           size_t end,
+                                           std::vector<Vertex>& outVertices,
+                                           std::vector<uint32_t>& outIndices);
+        };
+
+        // Index ranges drawn with their own vertexOffset, so every range can use 16-bit indices
+        struct Submesh
+        {
+            uint32_t firstIndex{};
+            uint32_t indexCount{};
+            int32_t vertexOffset{};
         };
 
-        VMVModel(VMVDevice& device, const Builder& builder);
+        struct Stats
+        {
+            uint32_t vertexCount{};
+            uint32_t indexCount{};
+            uint32_t submeshCount{};
+            uint32_t vertexSize{};
+            uint32_t indexSize{};
+            VkDeviceSize vertexBufferSize{};
+            VkDeviceSize indexBufferSize{};
+            VkDeviceSize indexBytesSaved{}; // compared to 32-bit indices
+        };
+
+        static constexpr uint32_t MAX_UINT16_VERTICES{1 << 16};
+
+        // Without an upload batch the model uploads and waits on its own, otherwise the buffers are only
+        // valid once the batch completes
+        VMVModel(VMVDevice& device, const Builder& builder, VMVUploadBatch* pUploadBatch = nullptr);
         ~VMVModel();
 
         VMVModel(const VMVModel&) = delete;
@@ -45,24 +127,72 @@ namespace vmv
         VMVModel& operator=(const VMVModel&) = delete;
         VMVModel& operator=(VMVModel&&) noexcept = delete;
 
-        static std::unique_ptr<VMVModel> CreateModelFromFile(VMVDevice& device, const std::string& filePath);
+        static std::unique_ptr<VMVModel> CreateModelFromFile(VMVDevice& device,
+                                                             const std::string& filePath,
+                                                             VertexFormat vertexFormat = VertexFormat::Full,
+                                                             bool splitSubmeshes = false,
+                                                             VMVUploadBatch* pUploadBatch = nullptr);
 
-        void Bind(VkCommandBuffer commandBuffer);
-        void Draw(VkCommandBuffer commandBuffer);
+        static uint32_t GetVertexSize(VertexFormat vertexFormat);
+
+        // Skips the buffers commandState already has bound
+        void Bind(VMVCommandState& commandState) const;
+        void Draw(VkCommandBuffer commandBuffer, uint32_t instanceCount = 1, uint32_t firstInstance = 0) const;
+
+        // True if drawing this after other binds nothing new, which is the case for models of the same layout
+        // since they all live in the device's geometry pool
+        bool SharesBuffersWith(const VMVModel& other) const;
+
+        // Draw writes one command per submesh, returns the number written
+        uint32_t WriteIndirectCommands(VkDrawIndexedIndirectCommand* pCommands,
+                                       uint32_t instanceCount,
+                                       uint32_t firstInstance) const;
+        uint32_t GetDrawCount() const { return m_HasIndexBuffer ? static_cast<uint32_t>(m_Submeshes.size()) : 1; }
+        bool IsIndexed() const { return m_HasIndexBuffer; }
+
+        Stats GetStats() const;
+        VertexFormat GetVertexFormat() const { return m_VertexFormat; }
+        VkIndexType GetIndexType() const { return m_IndexType; }
+        const std::vector<Submesh>& GetSubmeshes() const { return m_Submeshes; }
+        const glm::vec3& GetBoundsMin() const { return m_BoundsMin; }
+        const glm::vec3& GetBoundsMax() const { return m_BoundsMax; }
+
+        // Sphere (center, radius) around the AABB center enclosing every vertex, computed at load
+        const glm::vec4& GetBoundingSphere() const { return m_BoundingSphere; }
+
+        // Bounding sphere in the space of the vertex buffer positions, so quantized for packed models.
+        // Transformed by the same matrix the instanced shaders use.
+        glm::vec4 GetVertexBoundingSphere() const;
+
+        // Maps packed positions from [0, 1] back to the model AABB, identity for full vertices.
+        // Meant to be folded into the model matrix so the shader needs no extra uniforms.
+        glm::mat4 GetDequantizeMatrix() const;
 
       private:
         VMVDevice& m_VMVDevice;
 
-        std::unique_ptr<VMVBuffer> m_VertexBuffer;
+        VertexFormat m_VertexFormat;
+        glm::vec3 m_BoundsMin{};
+        glm::vec3 m_BoundsMax{};
+        glm::vec4 m_BoundingSphere{};
+
+        VMVGeometryPool::Range m_VertexRange{};
         uint32_t m_VertexCount;
 
-        void CreateVertexBuffers(const std::vector<Vertex>& vertices);
+        void CalculateBounds(const std::vector<Vertex>& vertices);
+        void CreateVertexBuffers(const std::vector<Vertex>& vertices, VMVUploadBatch& uploadBatch);
+        std::vector<PackedVertex> PackVertices(const std::vector<Vertex>& vertices) const;
 
         bool m_HasIndexBuffer{false};
-        std::unique_ptr<VMVBuffer> m_IndexBuffer;
+        VMVGeometryPool::Range m_IndexRange{};
         uint32_t m_IndexCount;
+        VkIndexType m_IndexType{VK_INDEX_TYPE_UINT32};
+        std::vector<Submesh> m_Submeshes{};
 
-        void CreateIndexBuffers(const std::vector<uint32_t>& indices);
+        void CreateIndexBuffers(const std::vector<uint32_t>& indices, VMVUploadBatch& uploadBatch);
+        static std::vector<Submesh> SplitSubmeshes(const Builder& builder,
+                                                   std::vector<Vertex>& outVertices,
+                                                   std::vector<uint32_t>& outIndices);
     };
 } // namespace vmv
 
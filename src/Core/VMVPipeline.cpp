@@ -1,9 +1,12 @@
 #include "VMVPipeline.h"
+#include "VMVPipelineCache.h"
 
 #include <cassert>
+#include <chrono>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <sstream>
 #include <stdexcept>
 
 vmv::VMVPipeline::VMVPipeline(VMVDevice& device,
@@ -16,11 +19,18 @@ vmv::VMVPipeline::VMVPipeline(VMVDevice& device,
     CreateGraphicsPipeline(configInfo, vertFilePath, fragFilePath);
 }
 
+vmv::VMVPipeline::VMVPipeline(VMVDevice& device, VkPipelineLayout pipelineLayout, const std::string& compFilePath)
+    : m_VMVDevice{device}, m_BindPoint{VK_PIPELINE_BIND_POINT_COMPUTE}
+{
+    CreateComputePipeline(pipelineLayout, compFilePath);
+}
+
 vmv::VMVPipeline::~VMVPipeline()
 {
     vkDestroyShaderModule(m_VMVDevice.device(), m_VertShaderModule, nullptr);
     vkDestroyShaderModule(m_VMVDevice.device(), m_FragShaderModule, nullptr);
-    vkDestroyPipeline(m_VMVDevice.device(), m_GraphicsPipeline, nullptr);
+    vkDestroyShaderModule(m_VMVDevice.device(), m_CompShaderModule, nullptr);
+    vkDestroyPipeline(m_VMVDevice.device(), m_Pipeline, nullptr);
 }
 
 void vmv::VMVPipeline::DefaultPipelineConfigInfo(PipelineConfigInfo& configInfo)
@@ -91,11 +101,19 @@ void vmv::VMVPipeline::DefaultPipelineConfigInfo(PipelineConfigInfo& configInfo)
     configInfo.dynamicStateInfo.pDynamicStates = configInfo.dynamicStateEnables.data();
     configInfo.dynamicStateInfo.dynamicStateCount = static_cast<uint32_t>(configInfo.dynamicStateEnables.size());
     configInfo.dynamicStateInfo.flags = 0;
+
+    configInfo.bindingDescriptions = VMVModel::Vertex::GetBindingDescriptions();
+    configInfo.attributeDescriptions = VMVModel::Vertex::GetAttributeDescriptions();
 }
 
 void vmv::VMVPipeline::Bind(VkCommandBuffer commandBuffer)
 {
-    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_GraphicsPipeline);
+    vkCmdBindPipeline(commandBuffer, m_BindPoint, m_Pipeline);
+}
+
+void vmv::VMVPipeline::Bind(VMVCommandState& commandState)
+{
+    commandState.BindPipeline(m_BindPoint, m_Pipeline);
 }
 
 std::vector<char> vmv::VMVPipeline::ReadFile(const std::string& filePath)
@@ -150,8 +168,8 @@ void vmv::VMVPipeline::CreateGraphicsPipeline(const PipelineConfigInfo& configIn
     shaderStages[1].pNext = nullptr;
     shaderStages[1].pSpecializationInfo = nullptr;
 
-    auto bindingDescriptions{VMVModel::Vertex::GetBindingDescriptions()};
-    auto attributeDescriptions{VMVModel::Vertex::GetAttributeDescriptions()};
+    const auto& bindingDescriptions{configInfo.bindingDescriptions};
+    const auto& attributeDescriptions{configInfo.attributeDescriptions};
 
     VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
     vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
@@ -180,11 +198,60 @@ void vmv::VMVPipeline::CreateGraphicsPipeline(const PipelineConfigInfo& configIn
     pipelineInfo.basePipelineIndex = -1;
     pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 
+    using namespace std::chrono;
+    const time_point start{high_resolution_clock::now()};
+
+    VMVPipelineCache& pipelineCache{m_VMVDevice.getPipelineCache()};
     if (vkCreateGraphicsPipelines(
-            m_VMVDevice.device(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_GraphicsPipeline) != VK_SUCCESS)
+            m_VMVDevice.device(), pipelineCache.GetCache(), 1, &pipelineInfo, nullptr, &m_Pipeline) != VK_SUCCESS)
     {
         throw std::runtime_error{"Failed to create graphics pipeline!"};
     }
+
+    LogCreationTime(vertFilePath + " + " + fragFilePath,
+                    duration<float, milliseconds::period>(high_resolution_clock::now() - start).count());
+}
+
+void vmv::VMVPipeline::CreateComputePipeline(VkPipelineLayout pipelineLayout, const std::string& compFilePath)
+{
+    assert(pipelineLayout != VK_NULL_HANDLE && "Cannot create compute pipeline: no pipelineLayout provided!");
+
+    std::vector<char> compCode{ReadFile(compFilePath)};
+    CreateShaderModule(compCode, &m_CompShaderModule);
+
+    VkPipelineShaderStageCreateInfo shaderStage{};
+    shaderStage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    shaderStage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    shaderStage.module = m_CompShaderModule;
+    shaderStage.pName = "main";
+
+    VkComputePipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage = shaderStage;
+    pipelineInfo.layout = pipelineLayout;
+    pipelineInfo.basePipelineIndex = -1;
+    pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+
+    using namespace std::chrono;
+    const time_point start{high_resolution_clock::now()};
+
+    VMVPipelineCache& pipelineCache{m_VMVDevice.getPipelineCache()};
+    if (vkCreateComputePipelines(
+            m_VMVDevice.device(), pipelineCache.GetCache(), 1, &pipelineInfo, nullptr, &m_Pipeline) != VK_SUCCESS)
+    {
+        throw std::runtime_error{"Failed to create compute pipeline!"};
+    }
+
+    LogCreationTime(compFilePath, duration<float, milliseconds::period>(high_resolution_clock::now() - start).count());
+}
+
+void vmv::VMVPipeline::LogCreationTime(const std::string& name, float creationTime) const
+{
+    // Pipelines are created on the pipeline library's threads, written at once so the lines don't interleave
+    std::ostringstream message{};
+    message << "Created pipeline " << name << " in " << creationTime << "ms ("
+            << (m_VMVDevice.getPipelineCache().IsWarm() ? "warm" : "cold") << " pipeline cache)\n";
+    std::cout << message.str();
 }
 
 void vmv::VMVPipeline::CreateShaderModule(const std::vector<char>& code, VkShaderModule* shaderModule)
@@ -1,6 +1,7 @@
 #ifndef VMV_VMVPIPELINE_H
 #define VMV_VMVPIPELINE_H
 
+#include "VMVCommandState.h"
 #include "VMVDevice.h"
 #include "VMVModel.h"
 
@@ -26,6 +27,9 @@ namespace vmv
         std::vector<VkDynamicState> dynamicStateEnables;
         VkPipelineDynamicStateCreateInfo dynamicStateInfo;
 
+        std::vector<VkVertexInputBindingDescription> bindingDescriptions{};
+        std::vector<VkVertexInputAttributeDescription> attributeDescriptions{};
+
         VkPipelineLayout pipelineLayout{nullptr};
         VkRenderPass renderPass{nullptr};
         uint32_t subpass{0};
@@ -39,6 +43,9 @@ namespace vmv
                     const std::string& vertFilePath,
                     const std::string& fragFilePath);
 
+        // Compute pipeline, Bind binds it to the compute bind point
+        VMVPipeline(VMVDevice& device, VkPipelineLayout pipelineLayout, const std::string& compFilePath);
+
         ~VMVPipeline();
         VMVPipeline(const VMVPipeline&) = delete;
         VMVPipeline(VMVPipeline&&) noexcept = delete;
@@ -48,6 +55,8 @@ namespace vmv
         static void DefaultPipelineConfigInfo(PipelineConfigInfo& configInfo);
 
         void Bind(VkCommandBuffer commandBuffer);
+        // Skips the bind if commandState already has this pipeline bound
+        void Bind(VMVCommandState& commandState);
 
       private:
         static std::vector<char> ReadFile(const std::string& filePath);
@@ -56,12 +65,19 @@ namespace vmv
                                     const std::string& vertFilePath,
                                     const std::string& fragFilePath);
 
+        void CreateComputePipeline(VkPipelineLayout pipelineLayout, const std::string& compFilePath);
+
         void CreateShaderModule(const std::vector<char>& code, VkShaderModule* shaderModule);
 
+        // creationTime in ms, only vkCreate*Pipelines, which is where the driver compiles
+        void LogCreationTime(const std::string& name, float creationTime) const;
+
         VMVDevice& m_VMVDevice;
-        VkPipeline m_GraphicsPipeline;
-        VkShaderModule m_VertShaderModule;
-        VkShaderModule m_FragShaderModule;
+        VkPipeline m_Pipeline{VK_NULL_HANDLE};
+        VkPipelineBindPoint m_BindPoint{VK_PIPELINE_BIND_POINT_GRAPHICS};
+        VkShaderModule m_VertShaderModule{VK_NULL_HANDLE};
+        VkShaderModule m_FragShaderModule{VK_NULL_HANDLE};
+        VkShaderModule m_CompShaderModule{VK_NULL_HANDLE};
     };
 } // namespace vmv
 
@@ -0,0 +1,158 @@
+#include "VMVPipelineCache.h"
+
+#include "VMVUtils.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <system_error>
+#include <vector>
+
+static_assert(sizeof(vmv::VMVPipelineCache::Header) % 8 == 0, "Pipeline cache header must keep the data aligned!");
+
+vmv::VMVPipelineCache::VMVPipelineCache(VkDevice device,
+                                        const VkPhysicalDeviceProperties& properties,
+                                        const std::string& filePath)
+    : m_Device{device}, m_Properties{properties}, m_FilePath{filePath}
+{
+    const std::vector<char> data{Load()};
+
+    VkPipelineCacheCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    createInfo.initialDataSize = data.size();
+    createInfo.pInitialData = data.data();
+
+    if (vkCreatePipelineCache(m_Device, &createInfo, nullptr, &m_Cache) != VK_SUCCESS)
+    {
+        // Drivers may still reject data that passed the checks, an empty cache only costs compile time
+        createInfo.initialDataSize = 0;
+        createInfo.pInitialData = nullptr;
+        if (vkCreatePipelineCache(m_Device, &createInfo, nullptr, &m_Cache) != VK_SUCCESS)
+        {
+            throw std::runtime_error{"Failed to create pipeline cache!"};
+        }
+    }
+    else
+    {
+        m_LoadedSize = data.size();
+        m_SavedHash = hashBytes(data.data(), data.size());
+    }
+
+    std::cout << "Pipeline cache: " << (IsWarm() ? "loaded " : "cold, no valid ") << m_FilePath;
+    if (IsWarm())
+    {
+        std::cout << " (" << m_LoadedSize / 1024 << " KiB)";
+    }
+    std::cout << '\n';
+}
+
+vmv::VMVPipelineCache::~VMVPipelineCache()
+{
+    Save();
+    vkDestroyPipelineCache(m_Device, m_Cache, nullptr);
+}
+
+vmv::VMVPipelineCache::Header vmv::VMVPipelineCache::MakeHeader() const
+{
+    Header header{};
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.vendorId = m_Properties.vendorID;
+    header.deviceId = m_Properties.deviceID;
+    header.driverVersion = m_Properties.driverVersion;
+    std::memcpy(header.pipelineCacheUuid, m_Properties.pipelineCacheUUID, VK_UUID_SIZE);
+    return header;
+}
+
+std::vector<char> vmv::VMVPipelineCache::Load() const
+{
+    std::ifstream file{m_FilePath, std::ios::ate | std::ios::binary};
+    if (!file.is_open())
+        return {};
+
+    const uint64_t fileSize{static_cast<uint64_t>(file.tellg())};
+    if (fileSize < sizeof(Header))
+        return {};
+
+    Header header{};
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(&header), sizeof(Header));
+
+    const Header expected{MakeHeader()};
+    if (header.magic != expected.magic || header.version != expected.version ||
+        header.vendorId != expected.vendorId || header.deviceId != expected.deviceId ||
+        header.driverVersion != expected.driverVersion ||
+        std::memcmp(header.pipelineCacheUuid, expected.pipelineCacheUuid, VK_UUID_SIZE) != 0 ||
+        header.dataSize != fileSize - sizeof(Header) || header.dataSize < sizeof(VkPipelineCacheHeaderVersionOne))
+    {
+        return {};
+    }
+
+    std::vector<char> data(header.dataSize);
+    file.read(data.data(), static_cast<std::streamsize>(header.dataSize));
+    if (!file || hashBytes(data.data(), data.size()) != header.dataHash)
+        return {};
+
+    // The driver's own header has to agree as well, some drivers don't check it themselves
+    VkPipelineCacheHeaderVersionOne cacheHeader{};
+    std::memcpy(&cacheHeader, data.data(), sizeof(cacheHeader));
+    if (cacheHeader.headerSize < sizeof(cacheHeader) ||
+        cacheHeader.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE ||
+        cacheHeader.vendorID != m_Properties.vendorID || cacheHeader.deviceID != m_Properties.deviceID ||
+        std::memcmp(cacheHeader.pipelineCacheUUID, m_Properties.pipelineCacheUUID, VK_UUID_SIZE) != 0)
+    {
+        return {};
+    }
+
+    return data;
+}
+
+void vmv::VMVPipelineCache::Save()
+{
+    size_t dataSize{};
+    if (vkGetPipelineCacheData(m_Device, m_Cache, &dataSize, nullptr) != VK_SUCCESS || dataSize == 0)
+        return;
+
+    std::vector<char> data(dataSize);
+    if (vkGetPipelineCacheData(m_Device, m_Cache, &dataSize, data.data()) != VK_SUCCESS)
+        return;
+
+    Header header{MakeHeader()};
+    header.dataSize = dataSize;
+    header.dataHash = hashBytes(data.data(), dataSize);
+    if (header.dataHash == m_SavedHash)
+        return;
+
+    // Write to a temporary file first so a crash never leaves a truncated cache behind
+    const std::string tempPath{m_FilePath + ".tmp"};
+    bool isWritten{false};
+    {
+        std::ofstream file{tempPath, std::ios::binary | std::ios::trunc};
+        if (!file.is_open())
+            return;
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+        file.write(data.data(), static_cast<std::streamsize>(dataSize));
+
+        file.close(); // flushes, so a full disk shows up here
+        isWritten = !file.fail();
+    }
+
+    // Never leave a partially written temporary file behind
+    std::error_code error{};
+    if (!isWritten)
+    {
+        std::filesystem::remove(tempPath, error);
+        return;
+    }
+
+    std::filesystem::rename(tempPath, m_FilePath, error);
+    if (error)
+    {
+        std::filesystem::remove(tempPath, error);
+        return;
+    }
+    m_SavedHash = header.dataHash;
+}
@@ -0,0 +1,68 @@
+#ifndef VMV_VMVPIPELINECACHE_H
+#define VMV_VMVPIPELINECACHE_H
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace vmv
+{
+    // Device wide VkPipelineCache loaded from a file at startup and written back on destruction, so shaders
+    // the driver compiled in an earlier run don't get compiled again.
+    // File layout: Header | vkGetPipelineCacheData bytes. The header and the Vulkan cache header inside the data
+    // are checked against the device, a file written for another GPU or driver is ignored.
+    class VMVPipelineCache final
+    {
+      public:
+        static constexpr uint32_t MAGIC{0x43505056}; // "VPPC"
+        static constexpr uint32_t VERSION{1};
+        static constexpr const char* DEFAULT_PATH{"pipeline_cache.bin"};
+
+        struct Header
+        {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t vendorId;
+            uint32_t deviceId;
+            uint32_t driverVersion;
+            uint32_t reserved;
+            uint8_t pipelineCacheUuid[VK_UUID_SIZE];
+            uint64_t dataSize;
+            uint64_t dataHash;
+        };
+
+        VMVPipelineCache(VkDevice device,
+                         const VkPhysicalDeviceProperties& properties,
+                         const std::string& filePath = DEFAULT_PATH);
+        ~VMVPipelineCache();
+
+        VMVPipelineCache(const VMVPipelineCache&) = delete;
+        VMVPipelineCache(VMVPipelineCache&&) noexcept = delete;
+        VMVPipelineCache& operator=(const VMVPipelineCache&) = delete;
+        VMVPipelineCache& operator=(VMVPipelineCache&&) noexcept = delete;
+
+        VkPipelineCache GetCache() const { return m_Cache; }
+
+        // True if the cache started from a valid file, pipelines created from it should skip most compilation
+        bool IsWarm() const { return m_LoadedSize > 0; }
+
+        // Writes the cache to the file unless the driver has nothing new since it was loaded or last saved
+        void Save();
+
+      private:
+        VkDevice m_Device;
+        VkPhysicalDeviceProperties m_Properties;
+        std::string m_FilePath;
+        VkPipelineCache m_Cache{VK_NULL_HANDLE};
+        uint64_t m_LoadedSize{};
+        uint64_t m_SavedHash{};
+
+        Header MakeHeader() const;
+        // Returns the cache data of the file if it matches this device, empty otherwise
+        std::vector<char> Load() const;
+    };
+} // namespace vmv
+
+#endif
\ No newline at end of file
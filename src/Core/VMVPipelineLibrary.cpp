@@ -0,0 +1,271 @@
+#include "VMVPipelineLibrary.h"
+
+#include <algorithm>
+#include <cassert>
+#include <exception>
+#include <iostream>
+#include <utility>
+
+bool vmv::VMVPipelineHandle::IsReady() const
+{
+    if (m_pEntry != nullptr && m_pEntry->isFailed.load(std::memory_order_acquire))
+    {
+        m_pEntry->compiledFuture.get();
+    }
+    return TryGet() != nullptr;
+}
+
+vmv::VMVPipeline* vmv::VMVPipelineHandle::TryGet() const
+{
+    return m_pEntry != nullptr ? m_pEntry->pReadyPipeline.load(std::memory_order_acquire) : nullptr;
+}
+
+vmv::VMVPipeline& vmv::VMVPipelineHandle::Get() const
+{
+    assert(m_pEntry != nullptr && "Cannot get the pipeline of an empty handle!");
+    m_pEntry->compiledFuture.get();
+    return *m_pEntry->pPipeline;
+}
+
+void vmv::VMVPipelineHandle::Wait() const
+{
+    assert(m_pEntry != nullptr && "Cannot wait on an empty pipeline handle!");
+    m_pEntry->compiledFuture.wait();
+}
+
+vmv::VMVPipelineLibrary::VMVPipelineLibrary(VMVDevice& device, uint32_t threadCount) : m_VMVDevice{device}
+{
+    if (threadCount == 0)
+    {
+        threadCount = std::max(std::thread::hardware_concurrency() / 2, 1u);
+    }
+
+    m_Threads.reserve(threadCount);
+    for (uint32_t i{}; i < threadCount; ++i)
+    {
+        m_Threads.emplace_back(&VMVPipelineLibrary::WorkerLoop, this);
+    }
+}
+
+vmv::VMVPipelineLibrary::~VMVPipelineLibrary()
+{
+    {
+        std::lock_guard lock{m_Mutex};
+        m_IsStopping = true;
+    }
+    m_WorkAvailable.notify_all();
+
+    // The workers empty the queue before they return, no handle is left with a broken promise
+    for (std::thread& thread : m_Threads)
+    {
+        thread.join();
+    }
+}
+
+vmv::VMVPipelineHandle vmv::VMVPipelineLibrary::RequestGraphicsPipeline(const PipelineConfigInfo& configInfo,
+                                                                        const std::string& vertFilePath,
+                                                                        const std::string& fragFilePath)
+{
+    std::string key{MakeKey(configInfo, vertFilePath, fragFilePath)};
+
+    std::lock_guard lock{m_Mutex};
+    ++m_Stats.requestCount;
+
+    if (const auto entryIt{m_Entries.find(key)}; entryIt != m_Entries.end())
+    {
+        if (std::shared_ptr<Entry> pEntry{entryIt->second.lock()})
+        {
+            ++m_Stats.deduplicatedCount;
+            return VMVPipelineHandle{std::move(pEntry)};
+        }
+    }
+
+    // Drop the entries nobody holds a handle to anymore, there are only a handful of pipelines
+    std::erase_if(m_Entries, [](const auto& entry) { return entry.second.expired(); });
+
+    std::shared_ptr<Entry> pEntry{std::make_shared<Entry>()};
+    CopyConfigInfo(configInfo, pEntry->configInfo);
+    pEntry->vertFilePath = vertFilePath;
+    pEntry->fragFilePath = fragFilePath;
+
+    m_Entries.insert_or_assign(std::move(key), pEntry);
+    m_Queue.push_back(pEntry);
+    ++m_Stats.pendingCount;
+    m_WorkAvailable.notify_one();
+
+    return VMVPipelineHandle{std::move(pEntry)};
+}
+
+vmv::VMVPipelineLibrary::Stats vmv::VMVPipelineLibrary::GetStats() const
+{
+    std::lock_guard lock{m_Mutex};
+    return m_Stats;
+}
+
+void vmv::VMVPipelineLibrary::WorkerLoop()
+{
+    std::unique_lock lock{m_Mutex};
+    while (true)
+    {
+        m_WorkAvailable.wait(lock, [this]() { return m_IsStopping || !m_Queue.empty(); });
+        if (m_Queue.empty())
+            return;
+
+        std::shared_ptr<Entry> pEntry{std::move(m_Queue.front())};
+        m_Queue.pop_front();
+
+        lock.unlock();
+        const bool isCompiled{Compile(*pEntry)};
+        pEntry.reset(); // may destroy the pipeline if every handle was dropped while compiling
+        lock.lock();
+
+        if (isCompiled)
+        {
+            ++m_Stats.compiledCount;
+        }
+        else
+        {
+            ++m_Stats.failedCount;
+        }
+        --m_Stats.pendingCount;
+    }
+}
+
+bool vmv::VMVPipelineLibrary::Compile(Entry& entry)
+{
+    try
+    {
+        entry.pPipeline =
+            std::make_unique<VMVPipeline>(m_VMVDevice, entry.configInfo, entry.vertFilePath, entry.fragFilePath);
+        entry.pReadyPipeline.store(entry.pPipeline.get(), std::memory_order_release);
+        entry.compiled.set_value();
+        return true;
+    }
+    catch (const std::exception& e)
+    {
+        // Draws using it are skipped, IsReady and Get rethrow
+        std::cerr << "Failed to compile pipeline " << entry.vertFilePath << " + " << entry.fragFilePath << ": "
+                  << e.what() << '\n';
+        entry.compiled.set_exception(std::current_exception());
+        entry.isFailed.store(true, std::memory_order_release);
+        return false;
+    }
+}
+
+std::string vmv::VMVPipelineLibrary::MakeKey(const PipelineConfigInfo& configInfo,
+                                             const std::string& vertFilePath,
+                                             const std::string& fragFilePath)
+{
+    // Field by field, the structs have padding and pointers that must not end up in the key
+    std::string key{};
+    const auto append{[&key](const auto& value) {
+        key.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }};
+    const auto appendString{[&](const std::string& string) {
+        append(string.size());
+        key += string;
+    }};
+
+    appendString(vertFilePath);
+    appendString(fragFilePath);
+
+    append(configInfo.viewportInfo.viewportCount);
+    append(configInfo.viewportInfo.scissorCount);
+
+    append(configInfo.inputAssemblyInfo.topology);
+    append(configInfo.inputAssemblyInfo.primitiveRestartEnable);
+
+    const VkPipelineRasterizationStateCreateInfo& rasterization{configInfo.rasterizationInfo};
+    append(rasterization.depthClampEnable);
+    append(rasterization.rasterizerDiscardEnable);
+    append(rasterization.polygonMode);
+    append(rasterization.cullMode);
+    append(rasterization.frontFace);
+    append(rasterization.depthBiasEnable);
+    append(rasterization.depthBiasConstantFactor);
+    append(rasterization.depthBiasClamp);
+    append(rasterization.depthBiasSlopeFactor);
+    append(rasterization.lineWidth);
+
+    const VkPipelineMultisampleStateCreateInfo& multisample{configInfo.multisampleInfo};
+    append(multisample.rasterizationSamples);
+    append(multisample.sampleShadingEnable);
+    append(multisample.minSampleShading);
+    append(multisample.alphaToCoverageEnable);
+    append(multisample.alphaToOneEnable);
+
+    const VkPipelineColorBlendAttachmentState& blend{configInfo.colorBlendAttachment};
+    append(blend.blendEnable);
+    append(blend.srcColorBlendFactor);
+    append(blend.dstColorBlendFactor);
+    append(blend.colorBlendOp);
+    append(blend.srcAlphaBlendFactor);
+    append(blend.dstAlphaBlendFactor);
+    append(blend.alphaBlendOp);
+    append(blend.colorWriteMask);
+
+    append(configInfo.colorBlendInfo.logicOpEnable);
+    append(configInfo.colorBlendInfo.logicOp);
+    append(configInfo.colorBlendInfo.attachmentCount);
+    append(configInfo.colorBlendInfo.blendConstants);
+
+    const VkPipelineDepthStencilStateCreateInfo& depthStencil{configInfo.depthStencilInfo};
+    append(depthStencil.depthTestEnable);
+    append(depthStencil.depthWriteEnable);
+    append(depthStencil.depthCompareOp);
+    append(depthStencil.depthBoundsTestEnable);
+    append(depthStencil.stencilTestEnable);
+    append(depthStencil.front); // VkStencilOpState is all 32 bit members, no padding
+    append(depthStencil.back);
+    append(depthStencil.minDepthBounds);
+    append(depthStencil.maxDepthBounds);
+
+    append(configInfo.dynamicStateEnables.size());
+    for (VkDynamicState dynamicState : configInfo.dynamicStateEnables)
+    {
+        append(dynamicState);
+    }
+    append(configInfo.bindingDescriptions.size());
+    for (const VkVertexInputBindingDescription& binding : configInfo.bindingDescriptions)
+    {
+        append(binding);
+    }
+    append(configInfo.attributeDescriptions.size());
+    for (const VkVertexInputAttributeDescription& attribute : configInfo.attributeDescriptions)
+    {
+        append(attribute);
+    }
+
+    append(configInfo.pipelineLayout);
+    append(configInfo.renderPass);
+    append(configInfo.subpass);
+
+    return key;
+}
+
+void vmv::VMVPipelineLibrary::CopyConfigInfo(const PipelineConfigInfo& source, PipelineConfigInfo& destination)
+{
+    assert(source.viewportInfo.pViewports == nullptr && source.viewportInfo.pScissors == nullptr &&
+           source.multisampleInfo.pSampleMask == nullptr && source.colorBlendInfo.attachmentCount <= 1 &&
+           "Only the pointers into PipelineConfigInfo itself can be copied!");
+
+    destination.viewportInfo = source.viewportInfo;
+    destination.inputAssemblyInfo = source.inputAssemblyInfo;
+    destination.rasterizationInfo = source.rasterizationInfo;
+    destination.multisampleInfo = source.multisampleInfo;
+    destination.colorBlendAttachment = source.colorBlendAttachment;
+    destination.colorBlendInfo = source.colorBlendInfo;
+    destination.depthStencilInfo = source.depthStencilInfo;
+    destination.dynamicStateEnables = source.dynamicStateEnables;
+    destination.dynamicStateInfo = source.dynamicStateInfo;
+    destination.bindingDescriptions = source.bindingDescriptions;
+    destination.attributeDescriptions = source.attributeDescriptions;
+    destination.pipelineLayout = source.pipelineLayout;
+    destination.renderPass = source.renderPass;
+    destination.subpass = source.subpass;
+
+    // Point at the copies, the source may be gone before the worker gets to it
+    destination.colorBlendInfo.pAttachments = &destination.colorBlendAttachment;
+    destination.dynamicStateInfo.pDynamicStates = destination.dynamicStateEnables.data();
+    destination.dynamicStateInfo.dynamicStateCount = static_cast<uint32_t>(destination.dynamicStateEnables.size());
+}
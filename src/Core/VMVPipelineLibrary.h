@@ -0,0 +1,121 @@
+#ifndef VMV_VMVPIPELINELIBRARY_H
+#define VMV_VMVPIPELINELIBRARY_H
+
+#include "VMVPipeline.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace vmv
+{
+    class VMVPipelineLibrary;
+
+    // Shared reference to a pipeline the library compiles in the background. The pipeline lives as long as any
+    // handle to it does.
+    class VMVPipelineHandle final
+    {
+      public:
+        VMVPipelineHandle() = default;
+
+        // Rethrows the error once compiling failed, so polling it is enough to notice
+        bool IsReady() const;
+        // nullptr while compiling or if compiling failed, cheap enough to call per draw
+        VMVPipeline* TryGet() const;
+        // Blocks until compiled, rethrows the error if compiling failed
+        VMVPipeline& Get() const;
+        // Blocks until compiled or failed, never throws
+        void Wait() const;
+
+      private:
+        friend class VMVPipelineLibrary;
+        struct Entry;
+
+        std::shared_ptr<Entry> m_pEntry{};
+
+        explicit VMVPipelineHandle(std::shared_ptr<Entry> pEntry) : m_pEntry{std::move(pEntry)} {}
+    };
+
+    // Compiles graphics pipelines on its own threads so creating them doesn't block the frame loop. Requests with
+    // the same shaders and PipelineConfigInfo, including layout and render pass, share one pipeline as long as a
+    // handle to it is alive. The pipelines go through the device's VMVPipelineCache, which is internally synced.
+    class VMVPipelineLibrary final
+    {
+      public:
+        struct Stats
+        {
+            uint32_t requestCount{};
+            uint32_t deduplicatedCount{}; // requests that got an existing pipeline
+            uint32_t compiledCount{};
+            uint32_t failedCount{};
+            uint32_t pendingCount{};
+        };
+
+        // 0 uses half the hardware threads, vkCreateGraphicsPipelines compiles on the thread calling it
+        explicit VMVPipelineLibrary(VMVDevice& device, uint32_t threadCount = 0);
+        // Waits for the compiles in flight, pipelines still referenced by handles stay alive
+        ~VMVPipelineLibrary();
+
+        VMVPipelineLibrary(const VMVPipelineLibrary&) = delete;
+        VMVPipelineLibrary(VMVPipelineLibrary&&) noexcept = delete;
+        VMVPipelineLibrary& operator=(const VMVPipelineLibrary&) = delete;
+        VMVPipelineLibrary& operator=(VMVPipelineLibrary&&) noexcept = delete;
+
+        // configInfo is copied, its layout and render pass have to stay valid until the handle is ready
+        VMVPipelineHandle RequestGraphicsPipeline(const PipelineConfigInfo& configInfo,
+                                                  const std::string& vertFilePath,
+                                                  const std::string& fragFilePath);
+
+        Stats GetStats() const;
+
+      private:
+        using Entry = VMVPipelineHandle::Entry;
+
+        VMVDevice& m_VMVDevice;
+        std::vector<std::thread> m_Threads{};
+
+        mutable std::mutex m_Mutex{};
+        std::condition_variable m_WorkAvailable{};
+
+        // Guarded by m_Mutex
+        std::unordered_map<std::string, std::weak_ptr<Entry>> m_Entries{}; // by MakeKey
+        std::deque<std::shared_ptr<Entry>> m_Queue{};
+        Stats m_Stats{};
+        bool m_IsStopping{false};
+
+        // Every field that ends up in the pipeline, with the shader paths. Used as is for lookups so two configs
+        // only share a pipeline if they are identical, not just if their hashes are.
+        static std::string MakeKey(const PipelineConfigInfo& configInfo,
+                                   const std::string& vertFilePath,
+                                   const std::string& fragFilePath);
+        // PipelineConfigInfo isn't copyable because it points into itself
+        static void CopyConfigInfo(const PipelineConfigInfo& source, PipelineConfigInfo& destination);
+
+        void WorkerLoop();
+        // Returns false if compiling failed
+        bool Compile(Entry& entry);
+    };
+
+    struct VMVPipelineHandle::Entry
+    {
+        PipelineConfigInfo configInfo{};
+        std::string vertFilePath{};
+        std::string fragFilePath{};
+
+        std::unique_ptr<VMVPipeline> pPipeline{};
+        std::atomic<VMVPipeline*> pReadyPipeline{nullptr}; // set once pPipeline is complete
+        std::atomic<bool> isFailed{false};                  // set once compiledFuture holds the error
+        std::promise<void> compiled{};
+        std::shared_future<void> compiledFuture{compiled.get_future().share()};
+    };
+} // namespace vmv
+
+#endif
\ No newline at end of file
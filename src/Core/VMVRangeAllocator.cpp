@@ -0,0 +1,97 @@
+#include "VMVRangeAllocator.h"
+
+#include <cassert>
+#include <iterator>
+
+vmv::VMVRangeAllocator::VMVRangeAllocator(uint64_t capacity) : m_Capacity{capacity}
+{
+    if (capacity > 0)
+    {
+        m_FreeRanges.emplace(0, capacity);
+    }
+}
+
+bool vmv::VMVRangeAllocator::Allocate(uint64_t size, uint64_t alignment, uint64_t& outOffset)
+{
+    assert(alignment > 0 && (alignment & (alignment - 1)) == 0 && "Alignment must be a power of two!");
+    if (size == 0)
+        return false;
+
+    auto bestRange{m_FreeRanges.end()};
+    uint64_t bestWaste{UINT64_MAX};
+    for (auto it{m_FreeRanges.begin()}; it != m_FreeRanges.end(); ++it)
+    {
+        const uint64_t alignedOffset{(it->first + alignment - 1) & ~(alignment - 1)};
+        const uint64_t padding{alignedOffset - it->first};
+        if (padding + size > it->second)
+            continue;
+
+        const uint64_t waste{it->second - size};
+        if (waste < bestWaste)
+        {
+            bestRange = it;
+            bestWaste = waste;
+            if (waste == 0)
+                break;
+        }
+    }
+
+    if (bestRange == m_FreeRanges.end())
+        return false;
+
+    const uint64_t rangeOffset{bestRange->first};
+    const uint64_t rangeSize{bestRange->second};
+    const uint64_t alignedOffset{(rangeOffset + alignment - 1) & ~(alignment - 1)};
+    const uint64_t padding{alignedOffset - rangeOffset};
+
+    // Alignment padding in front stays free, as does the remainder behind the allocation
+    m_FreeRanges.erase(bestRange);
+    if (padding > 0)
+    {
+        m_FreeRanges.emplace(rangeOffset, padding);
+    }
+    if (padding + size < rangeSize)
+    {
+        m_FreeRanges.emplace(alignedOffset + size, rangeSize - padding - size);
+    }
+
+    m_UsedSize += size;
+    outOffset = alignedOffset;
+    return true;
+}
+
+void vmv::VMVRangeAllocator::Free(uint64_t offset, uint64_t size)
+{
+    assert(offset + size <= m_Capacity && size <= m_UsedSize && "Freed range was never allocated!");
+    m_UsedSize -= size;
+
+    auto next{m_FreeRanges.lower_bound(offset)};
+    if (next != m_FreeRanges.begin())
+    {
+        auto previous{std::prev(next)};
+        if (previous->first + previous->second == offset)
+        {
+            offset = previous->first;
+            size += previous->second;
+            m_FreeRanges.erase(previous);
+        }
+    }
+
+    if (next != m_FreeRanges.end() && offset + size == next->first)
+    {
+        size += next->second;
+        m_FreeRanges.erase(next);
+    }
+
+    m_FreeRanges.emplace(offset, size);
+}
+
+uint64_t vmv::VMVRangeAllocator::GetLargestFreeRange() const
+{
+    uint64_t largest{};
+    for (const auto& [offset, size] : m_FreeRanges)
+    {
+        largest = size > largest ? size : largest;
+    }
+    return largest;
+}
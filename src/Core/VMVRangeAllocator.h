@@ -0,0 +1,36 @@
+#ifndef VMV_VMVRANGEALLOCATOR_H
+#define VMV_VMVRANGEALLOCATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+
+namespace vmv
+{
+    // Best-fit free-list allocator over an abstract range [0, capacity), neighbouring free ranges are merged on
+    // Free. Only does the bookkeeping, the caller owns whatever memory the offsets refer to.
+    class VMVRangeAllocator final
+    {
+      public:
+        explicit VMVRangeAllocator(uint64_t capacity);
+
+        // alignment must be a power of two
+        bool Allocate(uint64_t size, uint64_t alignment, uint64_t& outOffset);
+        void Free(uint64_t offset, uint64_t size);
+
+        uint64_t GetCapacity() const { return m_Capacity; }
+        uint64_t GetUsedSize() const { return m_UsedSize; }
+        uint64_t GetLargestFreeRange() const;
+        size_t GetFreeRangeCount() const { return m_FreeRanges.size(); }
+        bool IsEmpty() const { return m_UsedSize == 0; }
+
+      private:
+        uint64_t m_Capacity;
+        uint64_t m_UsedSize{};
+
+        // offset -> size
+        std::map<uint64_t, uint64_t> m_FreeRanges{};
+    };
+} // namespace vmv
+
+#endif
\ No newline at end of file
@@ -1,6 +1,10 @@
 #include "VMVRenderer.h"
 
+#include "VMVStagingRing.h"
+
+#include <algorithm>
 #include <array>
+#include <chrono>
 #include <stdexcept>
 
 vmv::VMVRenderer::VMVRenderer(VMVWindow& window, VMVDevice& device) : m_VMVWindow{window}, m_VMVDevice{device}
@@ -11,33 +15,172 @@ vmv::VMVRenderer::VMVRenderer(VMVWindow& window, VMVDevice& device) : m_VMVWindo
 
 vmv::VMVRenderer::~VMVRenderer()
 {
+    DestroySecondaryCommandPools();
     FreeCommandBuffers();
 }
 
 void vmv::VMVRenderer::FreeCommandBuffers()
 {
-    vkFreeCommandBuffers(m_VMVDevice.device(),
-                         m_VMVDevice.getCommandPool(),
-                         static_cast<uint32_t>(m_CommandBuffers.size()),
-                         m_CommandBuffers.data());
+    // Destroying the pools frees their command buffers
+    for (VkCommandPool commandPool : m_CommandPools)
+    {
+        vkDestroyCommandPool(m_VMVDevice.device(), commandPool, nullptr);
+    }
 
+    m_CommandPools.clear();
     m_CommandBuffers.clear();
 }
 
 void vmv::VMVRenderer::CreateCommandBuffers()
 {
+    m_CommandPools.resize(VMVSwapChain::MAX_FRAMES_IN_FLIGHT);
     m_CommandBuffers.resize(VMVSwapChain::MAX_FRAMES_IN_FLIGHT);
 
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.queueFamilyIndex = m_VMVDevice.findPhysicalQueueFamilies().graphicsFamily;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT; // reset as a whole in BeginFrame
+
     VkCommandBufferAllocateInfo allocInfo{};
     allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
     allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    allocInfo.commandPool = m_VMVDevice.getCommandPool();
-    allocInfo.commandBufferCount = static_cast<uint32_t>(m_CommandBuffers.size());
+    allocInfo.commandBufferCount = 1;
+
+    for (size_t i{}; i < m_CommandPools.size(); ++i)
+    {
+        if (vkCreateCommandPool(m_VMVDevice.device(), &poolInfo, nullptr, &m_CommandPools[i]) != VK_SUCCESS)
+        {
+            throw std::runtime_error{"Failed to create frame command pool!"};
+        }
+
+        allocInfo.commandPool = m_CommandPools[i];
+        if (vkAllocateCommandBuffers(m_VMVDevice.device(), &allocInfo, &m_CommandBuffers[i]) != VK_SUCCESS)
+        {
+            throw std::runtime_error{"Failed to allocate command buffers!"};
+        }
+    }
+}
+
+void vmv::VMVRenderer::CreateSecondaryCommandPools(uint32_t threadCount)
+{
+    assert(!m_IsFrameStarted && "Cannot create secondary command pools while frame is in progress!");
+
+    vkDeviceWaitIdle(m_VMVDevice.device());
+    DestroySecondaryCommandPools();
+
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.queueFamilyIndex = m_VMVDevice.findPhysicalQueueFamilies().graphicsFamily;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT; // reset as a whole when the frame comes around
+
+    m_SecondaryCommandPools.resize(VMVSwapChain::MAX_FRAMES_IN_FLIGHT);
+    for (std::vector<SecondaryCommandPool>& framePools : m_SecondaryCommandPools)
+    {
+        framePools.resize(threadCount);
+        for (SecondaryCommandPool& pool : framePools)
+        {
+            if (vkCreateCommandPool(m_VMVDevice.device(), &poolInfo, nullptr, &pool.commandPool) != VK_SUCCESS)
+            {
+                throw std::runtime_error{"Failed to create secondary command pool!"};
+            }
+        }
+    }
+    m_SecondaryThreadCount = threadCount;
+}
+
+void vmv::VMVRenderer::DestroySecondaryCommandPools()
+{
+    for (std::vector<SecondaryCommandPool>& framePools : m_SecondaryCommandPools)
+    {
+        for (SecondaryCommandPool& pool : framePools)
+        {
+            // Destroying the pool frees its command buffers
+            vkDestroyCommandPool(m_VMVDevice.device(), pool.commandPool, nullptr);
+        }
+    }
+    m_SecondaryCommandPools.clear();
+    m_SecondaryThreadCount = 0;
+}
+
+void vmv::VMVRenderer::ResetSecondaryCommandPools()
+{
+    if (m_SecondaryCommandPools.empty())
+        return;
+
+    // The frame's fence has been waited on in acquireNextImage, nothing from these pools is pending anymore
+    for (SecondaryCommandPool& pool : m_SecondaryCommandPools[m_CurrentFrameIndex])
+    {
+        if (pool.usedCount == 0)
+            continue;
+
+        vkResetCommandPool(m_VMVDevice.device(), pool.commandPool, 0);
+        pool.usedCount = 0;
+    }
+}
+
+VkCommandBuffer vmv::VMVRenderer::BeginSecondaryCommandBuffer(uint32_t threadIndex)
+{
+    assert(m_IsFrameStarted && "Cannot begin secondary command buffer if frame is not in progress!");
+    assert(threadIndex < m_SecondaryThreadCount && "No secondary command pool for this thread!");
+
+    SecondaryCommandPool& pool{m_SecondaryCommandPools[m_CurrentFrameIndex][threadIndex]};
+    if (pool.usedCount == pool.commandBuffers.size())
+    {
+        VkCommandBufferAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+        allocInfo.commandPool = pool.commandPool;
+        allocInfo.commandBufferCount = 1;
+
+        VkCommandBuffer commandBuffer{};
+        if (vkAllocateCommandBuffers(m_VMVDevice.device(), &allocInfo, &commandBuffer) != VK_SUCCESS)
+        {
+            throw std::runtime_error{"Failed to allocate secondary command buffer!"};
+        }
+        pool.commandBuffers.push_back(commandBuffer);
+    }
+    VkCommandBuffer commandBuffer{pool.commandBuffers[pool.usedCount++]};
 
-    if (vkAllocateCommandBuffers(m_VMVDevice.device(), &allocInfo, m_CommandBuffers.data()) != VK_SUCCESS)
+    VkCommandBufferInheritanceInfo inheritanceInfo{};
+    inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritanceInfo.renderPass = m_pVMVSwapChain->getRenderPass();
+    inheritanceInfo.subpass = 0;
+    inheritanceInfo.framebuffer = m_pVMVSwapChain->getFrameBuffer(m_CurrentImageIndex);
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+    if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
     {
-        throw std::runtime_error{"Failed to allocate command buffers!"};
+        throw std::runtime_error{"Failed to begin recording secondary command buffer!"};
     }
+
+    // Dynamic state is not inherited from the primary
+    SetViewportAndScissor(commandBuffer);
+    return commandBuffer;
+}
+
+void vmv::VMVRenderer::EndSecondaryCommandBuffer(VkCommandBuffer commandBuffer)
+{
+    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
+    {
+        throw std::runtime_error{"Failed to record secondary command buffer!"};
+    }
+}
+
+void vmv::VMVRenderer::ExecuteSecondaryCommandBuffers(VkCommandBuffer commandBuffer,
+                                                      const std::vector<VkCommandBuffer>& secondaryCommandBuffers)
+{
+    assert(commandBuffer == GetCurrentCommandBuffer() &&
+           "Cannot execute secondary command buffers on command buffer from a different frame!");
+
+    if (secondaryCommandBuffers.empty())
+        return;
+
+    vkCmdExecuteCommands(
+        commandBuffer, static_cast<uint32_t>(secondaryCommandBuffers.size()), secondaryCommandBuffers.data());
 }
 
 void vmv::VMVRenderer::RecreateSwapChain()
@@ -53,12 +196,12 @@ void vmv::VMVRenderer::RecreateSwapChain()
 
     if (m_pVMVSwapChain == nullptr)
     {
-        m_pVMVSwapChain = std::make_unique<VMVSwapChain>(m_VMVDevice, extent);
+        m_pVMVSwapChain = std::make_unique<VMVSwapChain>(m_VMVDevice, extent, m_SwapChainSettings);
     }
     else
     {
         std::shared_ptr<VMVSwapChain> oldSwapChain{std::move(m_pVMVSwapChain)};
-        m_pVMVSwapChain = std::make_unique<VMVSwapChain>(m_VMVDevice, extent, oldSwapChain);
+        m_pVMVSwapChain = std::make_unique<VMVSwapChain>(m_VMVDevice, extent, m_SwapChainSettings, oldSwapChain);
 
         if (!oldSwapChain->CompareSwapFormats(*m_pVMVSwapChain.get()))
         {
@@ -82,6 +225,12 @@ int vmv::VMVRenderer::GetFrameIndex() const
     return m_CurrentFrameIndex;
 }
 
+void vmv::VMVRenderer::WaitForNextFrame()
+{
+    assert(!m_IsFrameStarted && "Cannot wait for the next frame while frame is in progress!");
+    m_pVMVSwapChain->waitForCurrentFrame();
+}
+
 VkCommandBuffer vmv::VMVRenderer::BeginFrame()
 {
     assert(!m_IsFrameStarted && "Cannot begin frame while frame is in progress!");
@@ -98,18 +247,31 @@ VkCommandBuffer vmv::VMVRenderer::BeginFrame()
         throw std::runtime_error{"Failed to aquire next swapchain image!"};
     }
 
+    // A recreated swap chain starts over at its first frame, so follow it instead of counting separately
+    m_CurrentFrameIndex = static_cast<uint32_t>(m_pVMVSwapChain->getCurrentFrame());
     m_IsFrameStarted = true;
+    m_VMVDevice.getStagingRing().NextFrame();
+    ResetSecondaryCommandPools();
+
+    const auto start{std::chrono::high_resolution_clock::now()};
+
+    // The frame's fence has been waited on, so the whole pool can be recycled at once instead of having
+    // vkBeginCommandBuffer reset the buffer implicitly
+    vkResetCommandPool(m_VMVDevice.device(), m_CommandPools[m_CurrentFrameIndex], 0);
 
     VkCommandBuffer commandBuffer{GetCurrentCommandBuffer()};
 
     VkCommandBufferBeginInfo beginInfo{};
     beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 
     if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
     {
         throw std::runtime_error{"Failed to begin recording command buffer!"};
     }
 
+    m_CommandBufferTime =
+        std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
     return commandBuffer;
 }
 
@@ -117,12 +279,17 @@ void vmv::VMVRenderer::EndFrame()
 {
     assert(m_IsFrameStarted && "Cannot end frame while not in progress!");
 
+    const auto start{std::chrono::high_resolution_clock::now()};
+
     VkCommandBuffer commandBuffer{GetCurrentCommandBuffer()};
     if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
     {
         throw std::runtime_error{"Failed to record command buffer!"};
     }
 
+    m_CommandBufferTime +=
+        std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
     VkResult result{m_pVMVSwapChain->submitCommandBuffers(&commandBuffer, &m_CurrentImageIndex)};
 
     if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || m_VMVWindow.WasWindowResized())
@@ -136,10 +303,24 @@ void vmv::VMVRenderer::EndFrame()
     }
 
     m_IsFrameStarted = false;
-    m_CurrentFrameIndex = (m_CurrentFrameIndex + 1) % VMVSwapChain::MAX_FRAMES_IN_FLIGHT;
 }
 
-void vmv::VMVRenderer::BeginSwapChainRenderPass(VkCommandBuffer commandBuffer)
+void vmv::VMVRenderer::SetLatencyMode(VMVSwapChain::LatencyMode latencyMode)
+{
+    m_SwapChainSettings.latencyMode = latencyMode;
+    SetFramesInFlight(VMVSwapChain::getDefaultFramesInFlight(latencyMode));
+}
+
+void vmv::VMVRenderer::SetFramesInFlight(uint32_t framesInFlight)
+{
+    assert(!m_IsFrameStarted && "Cannot change the swap chain settings while frame is in progress!");
+
+    m_SwapChainSettings.framesInFlight =
+        std::clamp(framesInFlight, 1u, static_cast<uint32_t>(VMVSwapChain::MAX_FRAMES_IN_FLIGHT));
+    RecreateSwapChain();
+}
+
+void vmv::VMVRenderer::BeginSwapChainRenderPass(VkCommandBuffer commandBuffer, VkSubpassContents contents)
 {
     assert(m_IsFrameStarted && "Cannot call BeginSwapChainRenderPass if frame is not in progress!");
     assert(commandBuffer == GetCurrentCommandBuffer() &&
@@ -161,8 +342,16 @@ void vmv::VMVRenderer::BeginSwapChainRenderPass(VkCommandBuffer commandBuffer)
     renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
     renderPassInfo.pClearValues = clearValues.data();
 
-    vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+    vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, contents);
 
+    if (contents == VK_SUBPASS_CONTENTS_INLINE)
+    {
+        SetViewportAndScissor(commandBuffer);
+    }
+}
+
+void vmv::VMVRenderer::SetViewportAndScissor(VkCommandBuffer commandBuffer) const
+{
     VkViewport viewport{};
     viewport.x = 0.0f;
     viewport.y = 0.0f;
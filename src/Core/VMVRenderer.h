@@ -28,26 +28,73 @@ namespace vmv
         VkRenderPass GetSwapChainRenderPass() const { return m_pVMVSwapChain->getRenderPass(); }
         int GetFrameIndex() const;
         float GetAspectRatio() const { return m_pVMVSwapChain->extentAspectRatio(); }
+        // CPU time spent resetting, beginning and ending the last frame's primary command buffer, in ms
+        float GetCommandBufferTime() const { return m_CommandBufferTime; }
 
+        // Waits until the next frame's resources are free again, which BeginFrame would otherwise do after the
+        // caller already sampled input. Optional, see VMVFramePacer.
+        void WaitForNextFrame();
         VkCommandBuffer BeginFrame();
         void EndFrame();
 
-        void BeginSwapChainRenderPass(VkCommandBuffer commandBuffer);
+        // Both recreate the swap chain, call outside of a frame. Changing the latency mode also switches to the
+        // mode's default frames in flight, SetFramesInFlight can override it afterwards.
+        void SetLatencyMode(VMVSwapChain::LatencyMode latencyMode);
+        void SetFramesInFlight(uint32_t framesInFlight);
+        VMVSwapChain::LatencyMode GetLatencyMode() const { return m_SwapChainSettings.latencyMode; }
+        uint32_t GetFramesInFlight() const { return m_SwapChainSettings.framesInFlight; }
+        VkPresentModeKHR GetPresentMode() const { return m_pVMVSwapChain->getPresentMode(); }
+
+        // With VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS the pass may only execute secondary command buffers
+        // from BeginSecondaryCommandBuffer, viewport and scissor are then set in those instead
+        void BeginSwapChainRenderPass(VkCommandBuffer commandBuffer,
+                                      VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE);
         void EndSwapChainRenderPass(VkCommandBuffer commandBuffer);
 
+        // One command pool per thread and frame in flight, so threads can record secondaries without locking.
+        // Waits for the device, call outside of a frame.
+        void CreateSecondaryCommandPools(uint32_t threadCount);
+        uint32_t GetSecondaryThreadCount() const { return m_SecondaryThreadCount; }
+
+        // Secondary command buffer continuing the current swap chain render pass, valid for the current frame.
+        // Only the thread owning threadIndex may use it until it has been executed.
+        VkCommandBuffer BeginSecondaryCommandBuffer(uint32_t threadIndex);
+        void EndSecondaryCommandBuffer(VkCommandBuffer commandBuffer);
+        void ExecuteSecondaryCommandBuffers(VkCommandBuffer commandBuffer,
+                                            const std::vector<VkCommandBuffer>& secondaryCommandBuffers);
+
       private:
         VMVWindow& m_VMVWindow;
         VMVDevice& m_VMVDevice;
         std::unique_ptr<VMVSwapChain> m_pVMVSwapChain;
+        VMVSwapChain::Settings m_SwapChainSettings{};
+        // One pool per frame in flight holding just its primary command buffer. Single time commands use the
+        // device's pool, so resetting a frame's pool never touches them.
+        std::vector<VkCommandPool> m_CommandPools;
         std::vector<VkCommandBuffer> m_CommandBuffers;
 
         uint32_t m_CurrentImageIndex;
         uint32_t m_CurrentFrameIndex{};
 
         bool m_IsFrameStarted{false};
+        float m_CommandBufferTime{};
+
+        struct SecondaryCommandPool
+        {
+            VkCommandPool commandPool{VK_NULL_HANDLE};
+            std::vector<VkCommandBuffer> commandBuffers{}; // reused every time the frame comes around
+            size_t usedCount{};
+        };
+
+        // [frame in flight][thread]
+        std::vector<std::vector<SecondaryCommandPool>> m_SecondaryCommandPools{};
+        uint32_t m_SecondaryThreadCount{};
 
         void CreateCommandBuffers();
         void FreeCommandBuffers();
+        void DestroySecondaryCommandPools();
+        void ResetSecondaryCommandPools();
+        void SetViewportAndScissor(VkCommandBuffer commandBuffer) const;
         void RecreateSwapChain();
     };
 } // namespace vmv
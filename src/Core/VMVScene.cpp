@@ -0,0 +1,213 @@
+#include "VMVScene.h"
+
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <random>
+
+vmv::VMVScene::ModelId vmv::VMVScene::AddModel(std::shared_ptr<VMVModel> pModel)
+{
+    m_Models.push_back(std::move(pModel));
+    return static_cast<ModelId>(m_Models.size() - 1);
+}
+
+vmv::VMVScene::Entity vmv::VMVScene::CreateEntity(ModelId modelId, const Transform& transform)
+{
+    assert(modelId < m_Models.size() && "Model has not been added to the scene!");
+
+    uint32_t slot{};
+    if (m_FreeSlots.empty())
+    {
+        slot = static_cast<uint32_t>(m_Slots.size());
+        m_Slots.emplace_back();
+    }
+    else
+    {
+        slot = m_FreeSlots.back();
+        m_FreeSlots.pop_back();
+    }
+
+    m_Slots[slot].denseIndex = static_cast<uint32_t>(m_Transforms.size());
+    m_Transforms.push_back(transform);
+    m_ModelIds.push_back(modelId);
+    m_DenseSlots.push_back(slot);
+
+    return Entity{slot, m_Slots[slot].generation};
+}
+
+void vmv::VMVScene::DestroyEntity(Entity entity)
+{
+    const uint32_t denseIndex{GetDenseIndex(entity)};
+    const uint32_t lastIndex{static_cast<uint32_t>(m_Transforms.size() - 1)};
+    if (denseIndex != lastIndex)
+    {
+        m_Transforms[denseIndex] = m_Transforms[lastIndex];
+        m_ModelIds[denseIndex] = m_ModelIds[lastIndex];
+        m_DenseSlots[denseIndex] = m_DenseSlots[lastIndex];
+        m_Slots[m_DenseSlots[denseIndex]].denseIndex = denseIndex;
+    }
+    m_Transforms.pop_back();
+    m_ModelIds.pop_back();
+    m_DenseSlots.pop_back();
+
+    Slot& slot{m_Slots[entity.slot]};
+    slot.denseIndex = INVALID_SLOT;
+    ++slot.generation;
+    m_FreeSlots.push_back(entity.slot);
+}
+
+bool vmv::VMVScene::IsAlive(Entity entity) const
+{
+    return entity.slot < m_Slots.size() && m_Slots[entity.slot].generation == entity.generation &&
+           m_Slots[entity.slot].denseIndex != INVALID_SLOT;
+}
+
+void vmv::VMVScene::Reserve(size_t entityCount)
+{
+    m_Transforms.reserve(entityCount);
+    m_ModelIds.reserve(entityCount);
+    m_DenseSlots.reserve(entityCount);
+    m_Slots.reserve(entityCount);
+}
+
+void vmv::VMVScene::Clear()
+{
+    // Every live slot goes back to the free list with a new generation, so old handles stay invalid
+    for (uint32_t slot : m_DenseSlots)
+    {
+        m_Slots[slot].denseIndex = INVALID_SLOT;
+        ++m_Slots[slot].generation;
+        m_FreeSlots.push_back(slot);
+    }
+    m_Transforms.clear();
+    m_ModelIds.clear();
+    m_DenseSlots.clear();
+}
+
+vmv::VMVScene::Entity vmv::VMVScene::GetEntity(size_t denseIndex) const
+{
+    const uint32_t slot{m_DenseSlots[denseIndex]};
+    return Entity{slot, m_Slots[slot].generation};
+}
+
+uint32_t vmv::VMVScene::GetDenseIndex(Entity entity) const
+{
+    assert(IsAlive(entity) && "Entity has been destroyed!");
+    return m_Slots[entity.slot].denseIndex;
+}
+
+void vmv::VMVScene::RunBenchmark(size_t entityCount, const VMVScene& modelSource)
+{
+    constexpr uint32_t ITERATIONS{20};
+    constexpr float CHURN_FRACTION{.1f}; // of the entities destroyed and created again
+
+    assert(modelSource.GetModelCount() > 0 && "The scene benchmark needs at least one model!");
+    const ModelId modelCount{static_cast<ModelId>(modelSource.GetModelCount())};
+
+    std::mt19937 random{42};
+    std::uniform_real_distribution<float> position{-100.f, 100.f};
+    std::uniform_int_distribution<ModelId> model{0, modelCount - 1};
+
+    VMVScene scene{};
+    std::vector<std::shared_ptr<VMVModel>> models{};
+    for (ModelId i{}; i < modelCount; ++i)
+    {
+        models.push_back(modelSource.GetSharedModel(i));
+        scene.AddModel(models.back());
+    }
+
+    std::vector<VMVGameObject> gameObjects{};
+    gameObjects.reserve(entityCount);
+    scene.Reserve(entityCount);
+    for (size_t i{}; i < entityCount; ++i)
+    {
+        const ModelId modelId{model(random)};
+        Transform transform{};
+        transform.SetTranslation({position(random), position(random), position(random)});
+
+        VMVGameObject gameObject{VMVGameObject::CreateGameObject()};
+        gameObject.m_Model = models[modelId];
+        gameObject.m_Transform = transform;
+        gameObjects.push_back(std::move(gameObject));
+
+        scene.CreateEntity(modelId, transform);
+    }
+
+    // What the render systems read per object: the model to group by and the position to cull with
+    const auto timeIterations{[](auto&& iterate) {
+        float checksum{iterate()}; // untimed, faults everything in
+        using namespace std::chrono;
+        const time_point start{high_resolution_clock::now()};
+        for (uint32_t i{}; i < ITERATIONS; ++i)
+        {
+            checksum += iterate();
+        }
+        const float time{duration<float, milliseconds::period>(high_resolution_clock::now() - start).count()};
+        return std::pair{time / ITERATIONS, checksum};
+    }};
+
+    const auto [gameObjectTime, gameObjectChecksum]{timeIterations([&gameObjects, &models]() {
+        float sum{};
+        for (const VMVGameObject& go : gameObjects)
+        {
+            sum += go.m_Model.get() == models.front().get() ? go.m_Transform.GetTranslation().x : 0.f;
+        }
+        return sum;
+    })};
+
+    const auto [sceneTime, sceneChecksum]{timeIterations([&scene]() {
+        const std::span<const Transform> transforms{scene.GetTransforms()};
+        const std::span<const ModelId> modelIds{scene.GetModelIds()};
+        float sum{};
+        for (size_t i{}; i < modelIds.size(); ++i)
+        {
+            sum += modelIds[i] == 0 ? transforms[i].GetTranslation().x : 0.f;
+        }
+        return sum;
+    })};
+
+    std::cout << "Scene benchmark: " << entityCount << " entities, std::vector<VMVGameObject> " << gameObjectTime
+              << "ms, VMVScene " << sceneTime << "ms per iteration (" << gameObjectTime / sceneTime << "x)"
+              << (gameObjectChecksum == sceneChecksum ? "" : ", RESULTS DIFFER") << '\n';
+
+    // Churn: destroy random entities and create as many new ones, every handle has to keep finding its transform
+    std::vector<Entity> entities(entityCount);
+    for (size_t i{}; i < entityCount; ++i)
+    {
+        entities[i] = scene.GetEntity(i);
+        scene.GetTransform(entities[i]).SetScale(glm::vec3{static_cast<float>(i)});
+    }
+
+    const size_t churnCount{static_cast<size_t>(static_cast<float>(entityCount) * CHURN_FRACTION)};
+    std::uniform_int_distribution<size_t> index{0, entityCount - 1};
+    std::vector<size_t> churned(churnCount);
+    for (size_t& i : churned)
+    {
+        i = index(random);
+    }
+
+    using namespace std::chrono;
+    const time_point start{high_resolution_clock::now()};
+    size_t staleCount{};
+    for (size_t i : churned)
+    {
+        const Entity destroyed{entities[i]};
+        scene.DestroyEntity(destroyed);
+        Transform transform{};
+        transform.SetScale(glm::vec3{static_cast<float>(i)});
+        entities[i] = scene.CreateEntity(model(random), transform);
+        staleCount += scene.IsAlive(destroyed) ? 1 : 0;
+    }
+    const float churnTime{duration<float, milliseconds::period>(high_resolution_clock::now() - start).count()};
+
+    size_t mismatchCount{};
+    for (size_t i{}; i < entityCount; ++i)
+    {
+        mismatchCount += scene.GetTransform(entities[i]).GetScale().x == static_cast<float>(i) ? 0 : 1;
+    }
+
+    std::cout << "Scene benchmark: destroyed and created " << churnCount << " entities in " << churnTime << "ms, "
+              << mismatchCount << " handles lost their data, " << staleCount << " destroyed handles still alive, "
+              << scene.GetEntityCount() << " entities\n";
+}
\ No newline at end of file
@@ -0,0 +1,88 @@
+#ifndef VMV_VMVSCENE_H
+#define VMV_VMVSCENE_H
+
+#include "VMVGameObject.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace vmv
+{
+    // Entities stored as dense component arrays, index i of every array belongs to the same entity. Models are
+    // registered once and referenced by id. Destroying an entity moves the last one into its place, so the arrays
+    // stay contiguous but their order changes; entities are referred to by handles that survive that.
+    class VMVScene final
+    {
+      public:
+        using ModelId = uint32_t;
+
+        // Stable reference to an entity. The generation tells a destroyed entity from the one reusing its slot.
+        struct Entity
+        {
+            uint32_t slot{INVALID_SLOT};
+            uint32_t generation{};
+
+            bool operator==(const Entity&) const = default;
+        };
+
+        static constexpr uint32_t INVALID_SLOT{UINT32_MAX};
+
+        VMVScene() = default;
+
+        VMVScene(const VMVScene&) = delete;
+        VMVScene(VMVScene&&) noexcept = default;
+        VMVScene& operator=(const VMVScene&) = delete;
+        VMVScene& operator=(VMVScene&&) noexcept = default;
+
+        ModelId AddModel(std::shared_ptr<VMVModel> pModel);
+        const VMVModel& GetModel(ModelId modelId) const { return *m_Models[modelId]; }
+        const std::shared_ptr<VMVModel>& GetSharedModel(ModelId modelId) const { return m_Models[modelId]; }
+        size_t GetModelCount() const { return m_Models.size(); }
+
+        Entity CreateEntity(ModelId modelId, const Transform& transform = {});
+        void DestroyEntity(Entity entity);
+        bool IsAlive(Entity entity) const;
+        void Reserve(size_t entityCount);
+        void Clear();
+
+        Transform& GetTransform(Entity entity) { return m_Transforms[GetDenseIndex(entity)]; }
+        const Transform& GetTransform(Entity entity) const { return m_Transforms[GetDenseIndex(entity)]; }
+        ModelId GetModelId(Entity entity) const { return m_ModelIds[GetDenseIndex(entity)]; }
+        void SetModelId(Entity entity, ModelId modelId) { m_ModelIds[GetDenseIndex(entity)] = modelId; }
+
+        // The dense arrays, only valid until the next entity is created or destroyed
+        size_t GetEntityCount() const { return m_Transforms.size(); }
+        std::span<Transform> GetTransforms() { return m_Transforms; }
+        std::span<const Transform> GetTransforms() const { return m_Transforms; }
+        std::span<const ModelId> GetModelIds() const { return m_ModelIds; }
+        Entity GetEntity(size_t denseIndex) const;
+
+        // Iterates entityCount entities using the models of modelSource, stored here and in a
+        // std::vector<VMVGameObject> as the renderer did before, then creates and destroys entities at random and
+        // checks every handle still finds its data. Only reads the model pointers, the models need distinct ones.
+        static void RunBenchmark(size_t entityCount, const VMVScene& modelSource);
+
+      private:
+        struct Slot
+        {
+            uint32_t denseIndex{INVALID_SLOT}; // INVALID_SLOT while on the free list
+            uint32_t generation{};
+        };
+
+        std::vector<std::shared_ptr<VMVModel>> m_Models{};
+
+        std::vector<Transform> m_Transforms{};
+        std::vector<ModelId> m_ModelIds{};
+        std::vector<uint32_t> m_DenseSlots{}; // slot of every dense index, to fix up the moved entity
+
+        std::vector<Slot> m_Slots{};
+        std::vector<uint32_t> m_FreeSlots{};
+
+        uint32_t GetDenseIndex(Entity entity) const;
+    };
+} // namespace vmv
+
+#endif
\ No newline at end of file
@@ -0,0 +1,56 @@
+#ifndef VMV_VMVSIMD_H
+#define VMV_VMVSIMD_H
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define VMV_X86_SIMD
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// MSVC emits AVX intrinsics without /arch:AVX, GCC and Clang need the function compiled for the target.
+// Either way these functions may only run after isAvxSupported or isAvx2Supported returned true.
+#if defined(VMV_X86_SIMD) && !defined(_MSC_VER)
+#define VMV_TARGET_AVX __attribute__((target("avx")))
+#define VMV_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define VMV_TARGET_AVX
+#define VMV_TARGET_AVX2
+#endif
+
+namespace vmv
+{
+    // SSE2 is part of x86-64, so that only depends on the build
+    inline bool isAvxSupported()
+    {
+#if defined(VMV_X86_SIMD) && defined(_MSC_VER)
+        // AVX needs the CPU flag and the OS saving the YMM registers (OSXSAVE and XCR0 bits 1 and 2)
+        int cpuInfo[4]{};
+        __cpuid(cpuInfo, 1);
+        const bool hasAvx{(cpuInfo[2] & (1 << 28)) != 0};
+        const bool hasOsxsave{(cpuInfo[2] & (1 << 27)) != 0};
+        return hasAvx && hasOsxsave && (_xgetbv(0) & 0x6) == 0x6;
+#elif defined(VMV_X86_SIMD)
+        return __builtin_cpu_supports("avx");
+#else
+        return false;
+#endif
+    }
+
+    // 256 bit integer operations on top of AVX
+    inline bool isAvx2Supported()
+    {
+#if defined(VMV_X86_SIMD) && defined(_MSC_VER)
+        int cpuInfo[4]{};
+        __cpuidex(cpuInfo, 7, 0);
+        return isAvxSupported() && (cpuInfo[1] & (1 << 5)) != 0;
+#elif defined(VMV_X86_SIMD)
+        return __builtin_cpu_supports("avx2");
+#else
+        return false;
+#endif
+    }
+} // namespace vmv
+
+#endif
\ No newline at end of file
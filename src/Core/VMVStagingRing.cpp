@@ -0,0 +1,153 @@
+#include "VMVStagingRing.h"
+
+#include "VMVDevice.h"
+
+vmv::VMVStagingRing::VMVStagingRing(VMVDevice& device, VkDeviceSize capacity)
+    : m_VMVDevice{device}, m_Capacity{capacity}
+{
+    m_Buffer = std::make_unique<VMVBuffer>(device,
+                                           capacity,
+                                           1,
+                                           VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                           VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                                               VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    m_Buffer->map();
+}
+
+vmv::VMVStagingRing::~VMVStagingRing() {}
+
+vmv::VMVStagingRing::Allocation vmv::VMVStagingRing::Allocate(VkDeviceSize size, VkDeviceSize alignment)
+{
+    Allocation allocation{};
+    if (size == 0)
+        return allocation;
+
+    VkDeviceSize offset{};
+    bool isAllocated{size < m_Capacity && TryAllocate(size, alignment, offset)};
+    if (!isAllocated && size < m_Capacity)
+    {
+        Reclaim();
+        isAllocated = TryAllocate(size, alignment, offset);
+
+        // Wait on the oldest submitted regions until there is room. Regions that are not submitted yet
+        // cannot be waited on, those requests fall back to a dedicated buffer.
+        while (!isAllocated && !m_Regions.empty() && m_Regions.front().fence != VK_NULL_HANDLE)
+        {
+            vkWaitForFences(m_VMVDevice.device(), 1, &m_Regions.front().fence, VK_TRUE, UINT64_MAX);
+            ++m_FrameStats.stallCount;
+            ++m_TotalStats.stallCount;
+
+            Reclaim();
+            isAllocated = TryAllocate(size, alignment, offset);
+        }
+    }
+
+    if (!isAllocated)
+    {
+        ++m_FrameStats.fallbackCount;
+        ++m_TotalStats.fallbackCount;
+        return allocation;
+    }
+
+    m_Regions.push_back({offset, offset + size});
+    m_Head = offset + size;
+
+    allocation.buffer = m_Buffer->getBuffer();
+    allocation.offset = offset;
+    allocation.pMapped = static_cast<char*>(m_Buffer->getMappedMemory()) + offset;
+    allocation.regionId = m_FirstRegionId + m_Regions.size() - 1;
+
+    ++m_FrameStats.allocationCount;
+    ++m_TotalStats.allocationCount;
+    m_FrameStats.stagedBytes += size;
+    m_TotalStats.stagedBytes += size;
+    return allocation;
+}
+
+void vmv::VMVStagingRing::Submit(uint64_t regionId, VkFence fence)
+{
+    if (Region* pRegion{FindRegion(regionId)})
+    {
+        pRegion->fence = fence;
+    }
+}
+
+void vmv::VMVStagingRing::Release(uint64_t regionId)
+{
+    if (Region* pRegion{FindRegion(regionId)})
+    {
+        pRegion->isReleased = true;
+        pRegion->fence = VK_NULL_HANDLE;
+    }
+    Reclaim();
+}
+
+void vmv::VMVStagingRing::Reclaim()
+{
+    // Only the oldest regions can be freed, the ring stays contiguous
+    while (!m_Regions.empty())
+    {
+        const Region& region{m_Regions.front()};
+        const bool isDone{region.isReleased || (region.fence != VK_NULL_HANDLE &&
+                                                vkGetFenceStatus(m_VMVDevice.device(), region.fence) == VK_SUCCESS)};
+        if (!isDone)
+            break;
+
+        m_Regions.pop_front();
+        ++m_FirstRegionId;
+    }
+
+    if (m_Regions.empty())
+    {
+        m_Head = 0;
+    }
+}
+
+void vmv::VMVStagingRing::NextFrame()
+{
+    Reclaim();
+    m_PreviousFrameStats = m_FrameStats;
+    m_FrameStats = {};
+}
+
+bool vmv::VMVStagingRing::TryAllocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& outOffset)
+{
+    const VkDeviceSize alignedHead{(m_Head + alignment - 1) / alignment * alignment};
+    if (m_Regions.empty())
+    {
+        outOffset = 0;
+        return true;
+    }
+
+    // Strict comparisons keep head and tail from meeting, so head == tail always means empty
+    const VkDeviceSize tail{m_Regions.front().begin};
+    if (m_Head > tail)
+    {
+        if (alignedHead + size <= m_Capacity)
+        {
+            outOffset = alignedHead;
+            return true;
+        }
+        if (size < tail)
+        {
+            outOffset = 0;
+            return true;
+        }
+        return false;
+    }
+
+    if (alignedHead + size < tail)
+    {
+        outOffset = alignedHead;
+        return true;
+    }
+    return false;
+}
+
+vmv::VMVStagingRing::Region* vmv::VMVStagingRing::FindRegion(uint64_t regionId)
+{
+    if (regionId < m_FirstRegionId || regionId - m_FirstRegionId >= m_Regions.size())
+        return nullptr;
+
+    return &m_Regions[static_cast<size_t>(regionId - m_FirstRegionId)];
+}
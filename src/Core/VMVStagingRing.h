@@ -0,0 +1,83 @@
+#ifndef VMV_VMVSTAGINGRING_H
+#define VMV_VMVSTAGINGRING_H
+
+#include "VMVBuffer.h"
+
+#include <deque>
+#include <memory>
+
+namespace vmv
+{
+    class VMVDevice;
+
+    // One persistently mapped host-visible buffer handed out front to back as a ring. Every allocation is a
+    // region that stays live until its submission fence signals or its owner releases it, so staging never
+    // allocates device memory unless a request exceeds what the ring can free up.
+    class VMVStagingRing final
+    {
+      public:
+        struct Allocation
+        {
+            VkBuffer buffer{VK_NULL_HANDLE}; // VK_NULL_HANDLE if the ring had no room, use a dedicated buffer
+            VkDeviceSize offset{};
+            void* pMapped{nullptr};
+            uint64_t regionId{};
+        };
+
+        struct Stats
+        {
+            uint32_t allocationCount{};
+            uint32_t fallbackCount{}; // requests the ring could not serve
+            uint32_t stallCount{};    // waits on the GPU for space
+            VkDeviceSize stagedBytes{};
+        };
+
+        VMVStagingRing(VMVDevice& device, VkDeviceSize capacity);
+        ~VMVStagingRing();
+
+        VMVStagingRing(const VMVStagingRing&) = delete;
+        VMVStagingRing(VMVStagingRing&&) noexcept = delete;
+        VMVStagingRing& operator=(const VMVStagingRing&) = delete;
+        VMVStagingRing& operator=(VMVStagingRing&&) noexcept = delete;
+
+        Allocation Allocate(VkDeviceSize size, VkDeviceSize alignment);
+
+        // The fence must stay valid until the region is reclaimed or released
+        void Submit(uint64_t regionId, VkFence fence);
+        void Release(uint64_t regionId);
+        void Reclaim();
+
+        // Reclaims and starts a new set of frame counters
+        void NextFrame();
+
+        const Stats& GetFrameStats() const { return m_PreviousFrameStats; }
+        const Stats& GetTotalStats() const { return m_TotalStats; }
+        VkDeviceSize GetCapacity() const { return m_Capacity; }
+
+      private:
+        struct Region
+        {
+            VkDeviceSize begin{};
+            VkDeviceSize end{};
+            VkFence fence{VK_NULL_HANDLE};
+            bool isReleased{false};
+        };
+
+        VMVDevice& m_VMVDevice;
+        std::unique_ptr<VMVBuffer> m_Buffer;
+        VkDeviceSize m_Capacity;
+
+        std::deque<Region> m_Regions{};
+        uint64_t m_FirstRegionId{};
+        VkDeviceSize m_Head{};
+
+        Stats m_FrameStats{};
+        Stats m_PreviousFrameStats{};
+        Stats m_TotalStats{};
+
+        bool TryAllocate(VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& outOffset);
+        Region* FindRegion(uint64_t regionId);
+    };
+} // namespace vmv
+
+#endif
\ No newline at end of file
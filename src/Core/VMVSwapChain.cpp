@@ -1,6 +1,7 @@
 #include "VMVSwapChain.h"
 
 // std
+#include <algorithm>
 #include <array>
 #include <cstdlib>
 #include <cstring>
@@ -12,17 +13,53 @@
 namespace vmv
 {
 
-    VMVSwapChain::VMVSwapChain(VMVDevice& deviceRef, VkExtent2D extent) : device{deviceRef}, windowExtent{extent}
+    VMVSwapChain::VMVSwapChain(VMVDevice& deviceRef, VkExtent2D extent, const Settings& settings)
+        : device{deviceRef}, windowExtent{extent}, settings{settings}
     {
         Init();
     }
-    VMVSwapChain::VMVSwapChain(VMVDevice& deviceRef, VkExtent2D extent, std::shared_ptr<VMVSwapChain> pOldSwapChain)
-        : device{deviceRef}, windowExtent{extent}, pOldSwapChain{std::move(pOldSwapChain)}
+    VMVSwapChain::VMVSwapChain(VMVDevice& deviceRef,
+                               VkExtent2D extent,
+                               const Settings& settings,
+                               std::shared_ptr<VMVSwapChain> pOldSwapChain)
+        : device{deviceRef}, windowExtent{extent}, settings{settings}, pOldSwapChain{std::move(pOldSwapChain)}
     {
         Init();
 
-        // Clean up old swap chain since it's no longer needed
-        pOldSwapChain = nullptr;
+        // Clean up old swap chain since it's no longer needed, the parameter has been moved from so release the
+        // member, otherwise every swap chain would keep its predecessors alive
+        this->pOldSwapChain = nullptr;
+    }
+
+    uint32_t VMVSwapChain::getDefaultFramesInFlight(LatencyMode latencyMode)
+    {
+        switch (latencyMode)
+        {
+        case LatencyMode::LowLatency:
+            return 1;
+        case LatencyMode::Throughput:
+            return 3;
+        case LatencyMode::Balanced:
+        case LatencyMode::Uncapped:
+        default:
+            return 2;
+        }
+    }
+
+    const char* VMVSwapChain::getLatencyModeName(LatencyMode latencyMode)
+    {
+        switch (latencyMode)
+        {
+        case LatencyMode::Balanced:
+            return "balanced";
+        case LatencyMode::LowLatency:
+            return "low latency";
+        case LatencyMode::Throughput:
+            return "throughput";
+        case LatencyMode::Uncapped:
+        default:
+            return "uncapped";
+        }
     }
 
     VMVSwapChain::~VMVSwapChain()
@@ -43,7 +80,7 @@ namespace vmv
         {
             vkDestroyImageView(device.device(), depthImageViews[i], nullptr);
             vkDestroyImage(device.device(), depthImages[i], nullptr);
-            vkFreeMemory(device.device(), depthImageMemorys[i], nullptr);
+            device.getMemoryAllocator().Free(depthImageMemorys[i]);
         }
 
         for (auto framebuffer : swapChainFramebuffers)
@@ -54,7 +91,7 @@ namespace vmv
         vkDestroyRenderPass(device.device(), renderPass, nullptr);
 
         // cleanup synchronization objects
-        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+        for (size_t i = 0; i < inFlightFences.size(); i++)
         {
             vkDestroySemaphore(device.device(), renderFinishedSemaphores[i], nullptr);
             vkDestroySemaphore(device.device(), imageAvailableSemaphores[i], nullptr);
@@ -62,10 +99,15 @@ namespace vmv
         }
     }
 
-    VkResult VMVSwapChain::acquireNextImage(uint32_t* imageIndex)
+    void VMVSwapChain::waitForCurrentFrame()
     {
         vkWaitForFences(
             device.device(), 1, &inFlightFences[currentFrame], VK_TRUE, std::numeric_limits<uint64_t>::max());
+    }
+
+    VkResult VMVSwapChain::acquireNextImage(uint32_t* imageIndex)
+    {
+        waitForCurrentFrame();
 
         VkResult result =
             vkAcquireNextImageKHR(device.device(),
@@ -122,13 +164,15 @@ namespace vmv
 
         auto result = vkQueuePresentKHR(device.presentQueue(), &presentInfo);
 
-        currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+        currentFrame = (currentFrame + 1) % settings.framesInFlight;
 
         return result;
     }
 
     void VMVSwapChain::Init()
     {
+        settings.framesInFlight = std::clamp(settings.framesInFlight, 1u, static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT));
+
         createSwapChain();
         createImageViews();
         createRenderPass();
@@ -142,14 +186,9 @@ namespace vmv
         SwapChainSupportDetails swapChainSupport = device.getSwapChainSupport();
 
         VkSurfaceFormatKHR surfaceFormat = chooseSwapSurfaceFormat(swapChainSupport.formats);
-        VkPresentModeKHR presentMode = chooseSwapPresentMode(swapChainSupport.presentModes);
+        presentMode = chooseSwapPresentMode(swapChainSupport.presentModes);
         VkExtent2D extent = chooseSwapExtent(swapChainSupport.capabilities);
-
-        uint32_t imageCount = swapChainSupport.capabilities.minImageCount + 1;
-        if (swapChainSupport.capabilities.maxImageCount > 0 && imageCount > swapChainSupport.capabilities.maxImageCount)
-        {
-            imageCount = swapChainSupport.capabilities.maxImageCount;
-        }
+        uint32_t imageCount = chooseImageCount(swapChainSupport.capabilities, presentMode);
 
         VkSwapchainCreateInfoKHR createInfo = {};
         createInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
@@ -365,9 +404,9 @@ namespace vmv
 
     void VMVSwapChain::createSyncObjects()
     {
-        imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-        renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-        inFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
+        imageAvailableSemaphores.resize(settings.framesInFlight);
+        renderFinishedSemaphores.resize(settings.framesInFlight);
+        inFlightFences.resize(settings.framesInFlight);
         imagesInFlight.resize(imageCount(), VK_NULL_HANDLE);
 
         VkSemaphoreCreateInfo semaphoreInfo = {};
@@ -377,7 +416,7 @@ namespace vmv
         fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
         fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
 
-        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+        for (size_t i = 0; i < settings.framesInFlight; i++)
         {
             if (vkCreateSemaphore(device.device(), &semaphoreInfo, nullptr, &imageAvailableSemaphores[i]) !=
                     VK_SUCCESS ||
@@ -404,26 +443,79 @@ namespace vmv
         return availableFormats[0];
     }
 
+    const char* VMVSwapChain::getPresentModeName(VkPresentModeKHR presentMode)
+    {
+        switch (presentMode)
+        {
+        case VK_PRESENT_MODE_IMMEDIATE_KHR:
+            return "immediate";
+        case VK_PRESENT_MODE_MAILBOX_KHR:
+            return "mailbox";
+        case VK_PRESENT_MODE_FIFO_KHR:
+            return "FIFO";
+        case VK_PRESENT_MODE_FIFO_RELAXED_KHR:
+            return "FIFO relaxed";
+        default:
+            return "unknown";
+        }
+    }
+
     VkPresentModeKHR VMVSwapChain::chooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes)
     {
-        for (const auto& availablePresentMode : availablePresentModes)
+        const auto isAvailable = [&availablePresentModes](VkPresentModeKHR presentMode) {
+            return std::find(availablePresentModes.begin(), availablePresentModes.end(), presentMode) !=
+                   availablePresentModes.end();
+        };
+
+        switch (settings.latencyMode)
         {
-            if (availablePresentMode == VK_PRESENT_MODE_MAILBOX_KHR)
+        case LatencyMode::Balanced:
+        case LatencyMode::LowLatency:
+            // Mailbox replaces queued images instead of waiting behind them
+            if (isAvailable(VK_PRESENT_MODE_MAILBOX_KHR))
             {
-                return availablePresentMode;
+                return VK_PRESENT_MODE_MAILBOX_KHR;
             }
+            break;
+        case LatencyMode::Uncapped:
+            if (isAvailable(VK_PRESENT_MODE_IMMEDIATE_KHR))
+            {
+                return VK_PRESENT_MODE_IMMEDIATE_KHR;
+            }
+            if (isAvailable(VK_PRESENT_MODE_MAILBOX_KHR))
+            {
+                return VK_PRESENT_MODE_MAILBOX_KHR;
+            }
+            break;
+        case LatencyMode::Throughput:
+            break;
         }
 
-        // for (const auto &availablePresentMode : availablePresentModes) {
-        //   if (availablePresentMode == VK_PRESENT_MODE_IMMEDIATE_KHR) {
-        //     std::cout << "Present mode: Immediate" << std::endl;
-        //     return availablePresentMode;
-        //   }
-        // }
-
+        // FIFO is the only mode that is always supported
         return VK_PRESENT_MODE_FIFO_KHR;
     }
 
+    uint32_t VMVSwapChain::chooseImageCount(const VkSurfaceCapabilitiesKHR& capabilities, VkPresentModeKHR presentMode)
+    {
+        // Low latency FIFO keeps as few images queued as possible, everything else wants a spare one so
+        // rendering doesn't stall on presentation
+        uint32_t imageCount = capabilities.minImageCount + 1;
+        if (settings.latencyMode == LatencyMode::LowLatency && presentMode == VK_PRESENT_MODE_FIFO_KHR)
+        {
+            imageCount = capabilities.minImageCount;
+        }
+        else if (settings.latencyMode == LatencyMode::Throughput)
+        {
+            imageCount = std::max(imageCount, settings.framesInFlight);
+        }
+
+        if (capabilities.maxImageCount > 0 && imageCount > capabilities.maxImageCount)
+        {
+            imageCount = capabilities.maxImageCount;
+        }
+        return imageCount;
+    }
+
     VkExtent2D VMVSwapChain::chooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities)
     {
         if (capabilities.currentExtent.width != std::numeric_limits<uint32_t>::max())
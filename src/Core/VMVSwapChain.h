@@ -16,10 +16,34 @@ namespace vmv
     class VMVSwapChain final
     {
       public:
-        static constexpr int MAX_FRAMES_IN_FLIGHT = 2;
+        // Per frame resources are allocated for the maximum, so the frames in flight can change at runtime
+        static constexpr int MAX_FRAMES_IN_FLIGHT = 4;
 
-        VMVSwapChain(VMVDevice& deviceRef, VkExtent2D windowExtent);
-        VMVSwapChain(VMVDevice& deviceRef, VkExtent2D windowExtent, std::shared_ptr<VMVSwapChain> pOldSwapChain);
+        // Trades input latency against throughput by picking the present mode, image count and how many frames
+        // the CPU may run ahead of the GPU
+        enum class LatencyMode
+        {
+            Balanced,   // mailbox or FIFO with a spare image and two frames in flight, as before the modes existed
+            LowLatency, // mailbox or FIFO with the fewest images, one frame in flight
+            Throughput, // FIFO with a spare image and three frames in flight, never tears or drops frames
+            Uncapped    // immediate or mailbox, renders as fast as the GPU allows
+        };
+
+        struct Settings
+        {
+            LatencyMode latencyMode = LatencyMode::Balanced;
+            uint32_t framesInFlight = getDefaultFramesInFlight(latencyMode); // 1 to MAX_FRAMES_IN_FLIGHT
+        };
+
+        static uint32_t getDefaultFramesInFlight(LatencyMode latencyMode);
+        static const char* getLatencyModeName(LatencyMode latencyMode);
+        static const char* getPresentModeName(VkPresentModeKHR presentMode);
+
+        VMVSwapChain(VMVDevice& deviceRef, VkExtent2D windowExtent, const Settings& settings);
+        VMVSwapChain(VMVDevice& deviceRef,
+                     VkExtent2D windowExtent,
+                     const Settings& settings,
+                     std::shared_ptr<VMVSwapChain> pOldSwapChain);
         ~VMVSwapChain();
 
         VMVSwapChain(const VMVSwapChain&) = delete;
@@ -31,6 +55,10 @@ namespace vmv
         size_t imageCount() { return swapChainImages.size(); }
         VkFormat getSwapChainImageFormat() { return swapChainImageFormat; }
         VkExtent2D getSwapChainExtent() { return swapChainExtent; }
+        VkPresentModeKHR getPresentMode() const { return presentMode; }
+        const Settings& getSettings() const { return settings; }
+        // Index of the frame in flight the next acquireNextImage waits for
+        size_t getCurrentFrame() const { return currentFrame; }
         uint32_t width() { return swapChainExtent.width; }
         uint32_t height() { return swapChainExtent.height; }
 
@@ -40,6 +68,8 @@ namespace vmv
         }
         VkFormat findDepthFormat();
 
+        // Blocks until the GPU is done with the frame acquireNextImage is going to reuse
+        void waitForCurrentFrame();
         VkResult acquireNextImage(uint32_t* imageIndex);
         VkResult submitCommandBuffers(const VkCommandBuffer* buffers, uint32_t* imageIndex);
 
@@ -63,23 +93,26 @@ namespace vmv
         VkSurfaceFormatKHR chooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& availableFormats);
         VkPresentModeKHR chooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes);
         VkExtent2D chooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities);
+        uint32_t chooseImageCount(const VkSurfaceCapabilitiesKHR& capabilities, VkPresentModeKHR presentMode);
 
         VkFormat swapChainImageFormat;
         VkFormat swapChainDepthFormat;
 
         VkExtent2D swapChainExtent;
+        VkPresentModeKHR presentMode;
 
         std::vector<VkFramebuffer> swapChainFramebuffers;
         VkRenderPass renderPass;
 
         std::vector<VkImage> depthImages;
-        std::vector<VkDeviceMemory> depthImageMemorys;
+        std::vector<VMVMemoryAllocator::Allocation> depthImageMemorys;
         std::vector<VkImageView> depthImageViews;
         std::vector<VkImage> swapChainImages;
         std::vector<VkImageView> swapChainImageViews;
 
         VMVDevice& device;
         VkExtent2D windowExtent;
+        Settings settings;
 
         VkSwapchainKHR swapChain;
         std::shared_ptr<VMVSwapChain> pOldSwapChain;
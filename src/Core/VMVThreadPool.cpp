@@ -0,0 +1,97 @@
+#include "VMVThreadPool.h"
+
+#include <algorithm>
+#include <utility>
+
+vmv::VMVThreadPool::VMVThreadPool(uint32_t threadCount)
+{
+    if (threadCount == 0)
+    {
+        threadCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+    }
+
+    m_Threads.reserve(threadCount);
+    for (uint32_t i{}; i < threadCount; ++i)
+    {
+        m_Threads.emplace_back(&VMVThreadPool::WorkerLoop, this, i);
+    }
+}
+
+vmv::VMVThreadPool::~VMVThreadPool()
+{
+    {
+        std::lock_guard lock{m_Mutex};
+        m_IsStopping = true;
+    }
+    m_WorkAvailable.notify_all();
+
+    for (std::thread& thread : m_Threads)
+    {
+        thread.join();
+    }
+}
+
+void vmv::VMVThreadPool::ParallelFor(uint32_t taskCount, const Task& task)
+{
+    if (taskCount == 0)
+        return;
+
+    std::unique_lock lock{m_Mutex};
+    m_pTask = &task;
+    m_TaskCount = taskCount;
+    m_NextTask = 0;
+    m_FinishedTasks = 0;
+    m_Exception = nullptr;
+    ++m_Generation;
+    m_WorkAvailable.notify_all();
+
+    m_WorkDone.wait(lock, [this]() { return m_FinishedTasks == m_TaskCount; });
+    m_pTask = nullptr;
+
+    if (m_Exception)
+    {
+        std::rethrow_exception(std::exchange(m_Exception, nullptr));
+    }
+}
+
+void vmv::VMVThreadPool::WorkerLoop(uint32_t threadIndex)
+{
+    uint64_t seenGeneration{};
+    std::unique_lock lock{m_Mutex};
+    while (true)
+    {
+        m_WorkAvailable.wait(lock, [&]() { return m_IsStopping || m_Generation != seenGeneration; });
+        if (m_IsStopping)
+            return;
+
+        seenGeneration = m_Generation;
+
+        // Tasks are claimed one at a time so uneven tasks still spread over every worker
+        while (m_pTask != nullptr && m_NextTask < m_TaskCount)
+        {
+            const uint32_t taskIndex{m_NextTask++};
+            const Task& task{*m_pTask};
+
+            lock.unlock();
+            std::exception_ptr exception{};
+            try
+            {
+                task(taskIndex, threadIndex);
+            }
+            catch (...)
+            {
+                exception = std::current_exception();
+            }
+            lock.lock();
+
+            if (exception && !m_Exception)
+            {
+                m_Exception = exception;
+            }
+            if (++m_FinishedTasks == m_TaskCount)
+            {
+                m_WorkDone.notify_one();
+            }
+        }
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef VMV_VMVTHREADPOOL_H
+#define VMV_VMVTHREADPOOL_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace vmv
+{
+    // Fixed set of worker threads running the tasks of one ParallelFor at a time. Every task is handed the index
+    // of the worker running it, so callers can keep per-thread resources such as command pools.
+    class VMVThreadPool final
+    {
+      public:
+        using Task = std::function<void(uint32_t taskIndex, uint32_t threadIndex)>;
+
+        // 0 uses one thread per hardware thread, minus the calling thread
+        explicit VMVThreadPool(uint32_t threadCount = 0);
+        ~VMVThreadPool();
+
+        VMVThreadPool(const VMVThreadPool&) = delete;
+        VMVThreadPool(VMVThreadPool&&) noexcept = delete;
+        VMVThreadPool& operator=(const VMVThreadPool&) = delete;
+        VMVThreadPool& operator=(VMVThreadPool&&) noexcept = delete;
+
+        // Runs task for every index in [0, taskCount) on the workers and returns once all of them finished.
+        // Rethrows the first exception a task threw.
+        void ParallelFor(uint32_t taskCount, const Task& task);
+
+        uint32_t GetThreadCount() const { return static_cast<uint32_t>(m_Threads.size()); }
+
+      private:
+        std::vector<std::thread> m_Threads{};
+
+        std::mutex m_Mutex{};
+        std::condition_variable m_WorkAvailable{};
+        std::condition_variable m_WorkDone{};
+
+        // Guarded by m_Mutex
+        const Task* m_pTask{nullptr};
+        uint32_t m_TaskCount{};
+        uint32_t m_NextTask{};
+        uint32_t m_FinishedTasks{};
+        uint64_t m_Generation{};
+        std::exception_ptr m_Exception{};
+        bool m_IsStopping{false};
+
+        void WorkerLoop(uint32_t threadIndex);
+    };
+} // namespace vmv
+
+#endif
\ No newline at end of file
@@ -0,0 +1,523 @@
+#include "VMVTransformBatch.h"
+#include "VMVSimd.h"
+
+#include <glm/gtc/constants.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+namespace
+{
+    // Cody-Waite reduction by pi/2 in three parts, then the single precision sin/cos polynomials from Cephes,
+    // accurate to a few ulp for the angle range transforms use
+    constexpr float TWO_OVER_PI{0.636619772367581343f};
+    constexpr float PI_OVER_2_PART1{1.5703125f};
+    constexpr float PI_OVER_2_PART2{4.837512969970703125e-4f};
+    constexpr float PI_OVER_2_PART3{7.54978995489188216e-8f};
+    constexpr float SIN_C0{-1.9515295891e-4f};
+    constexpr float SIN_C1{8.3321608736e-3f};
+    constexpr float SIN_C2{-1.6666654611e-1f};
+    constexpr float COS_C0{2.443315711809948e-5f};
+    constexpr float COS_C1{-1.388731625493765e-3f};
+    constexpr float COS_C2{4.166664568298827e-2f};
+
+    constexpr size_t FLOATS_PER_MATRICES{32};
+    constexpr size_t NORMAL_MATRIX_OFFSET{16};
+    static_assert(sizeof(vmv::VMVTransformBatch::Matrices) == FLOATS_PER_MATRICES * sizeof(float));
+
+#if defined(VMV_X86_SIMD)
+    void SinCosSse(__m128 x, __m128& outSin, __m128& outCos)
+    {
+        const __m128i quadrant{_mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(TWO_OVER_PI)))};
+        const __m128 j{_mm_cvtepi32_ps(quadrant)};
+        __m128 r{_mm_sub_ps(x, _mm_mul_ps(j, _mm_set1_ps(PI_OVER_2_PART1)))};
+        r = _mm_sub_ps(r, _mm_mul_ps(j, _mm_set1_ps(PI_OVER_2_PART2)));
+        r = _mm_sub_ps(r, _mm_mul_ps(j, _mm_set1_ps(PI_OVER_2_PART3)));
+        const __m128 z{_mm_mul_ps(r, r)};
+
+        __m128 sin{_mm_add_ps(_mm_mul_ps(_mm_set1_ps(SIN_C0), z), _mm_set1_ps(SIN_C1))};
+        sin = _mm_add_ps(_mm_mul_ps(sin, z), _mm_set1_ps(SIN_C2));
+        sin = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(sin, z), r), r);
+
+        __m128 cos{_mm_add_ps(_mm_mul_ps(_mm_set1_ps(COS_C0), z), _mm_set1_ps(COS_C1))};
+        cos = _mm_add_ps(_mm_mul_ps(cos, z), _mm_set1_ps(COS_C2));
+        cos = _mm_sub_ps(_mm_mul_ps(_mm_mul_ps(cos, z), z), _mm_mul_ps(_mm_set1_ps(.5f), z));
+        cos = _mm_add_ps(cos, _mm_set1_ps(1.f));
+
+        // Quadrants 1 and 3 swap sin and cos, sin is negative in 2 and 3, cos in 1 and 2
+        const __m128i one{_mm_set1_epi32(1)};
+        const __m128i two{_mm_set1_epi32(2)};
+        const __m128 isSwapped{_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, one), one))};
+        const __m128 isSinNegative{_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(quadrant, two), two))};
+        const __m128 isCosNegative{
+            _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(_mm_add_epi32(quadrant, one), two), two))};
+
+        const __m128 signBit{_mm_set1_ps(-0.f)};
+        outSin = _mm_or_ps(_mm_and_ps(isSwapped, cos), _mm_andnot_ps(isSwapped, sin));
+        outCos = _mm_or_ps(_mm_and_ps(isSwapped, sin), _mm_andnot_ps(isSwapped, cos));
+        outSin = _mm_xor_ps(outSin, _mm_and_ps(isSinNegative, signBit));
+        outCos = _mm_xor_ps(outCos, _mm_and_ps(isCosNegative, signBit));
+    }
+
+    // x, y, z and w hold one matrix column of four transforms, each is written to its own matrix
+    void StoreColumnSse(float* pFirst, size_t validCount, __m128 x, __m128 y, __m128 z, __m128 w)
+    {
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+        if (validCount == 4)
+        {
+            _mm_storeu_ps(pFirst, x);
+            _mm_storeu_ps(pFirst + FLOATS_PER_MATRICES, y);
+            _mm_storeu_ps(pFirst + 2 * FLOATS_PER_MATRICES, z);
+            _mm_storeu_ps(pFirst + 3 * FLOATS_PER_MATRICES, w);
+            return;
+        }
+
+        // Last group, the lanes past the end are padding
+        const __m128 columns[4]{x, y, z, w};
+        for (size_t lane{}; lane < validCount; ++lane)
+        {
+            _mm_storeu_ps(pFirst + lane * FLOATS_PER_MATRICES, columns[lane]);
+        }
+    }
+
+    VMV_TARGET_AVX2 void SinCosAvx2(__m256 x, __m256& outSin, __m256& outCos)
+    {
+        const __m256i quadrant{_mm256_cvtps_epi32(_mm256_mul_ps(x, _mm256_set1_ps(TWO_OVER_PI)))};
+        const __m256 j{_mm256_cvtepi32_ps(quadrant)};
+        __m256 r{_mm256_sub_ps(x, _mm256_mul_ps(j, _mm256_set1_ps(PI_OVER_2_PART1)))};
+        r = _mm256_sub_ps(r, _mm256_mul_ps(j, _mm256_set1_ps(PI_OVER_2_PART2)));
+        r = _mm256_sub_ps(r, _mm256_mul_ps(j, _mm256_set1_ps(PI_OVER_2_PART3)));
+        const __m256 z{_mm256_mul_ps(r, r)};
+
+        __m256 sin{_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(SIN_C0), z), _mm256_set1_ps(SIN_C1))};
+        sin = _mm256_add_ps(_mm256_mul_ps(sin, z), _mm256_set1_ps(SIN_C2));
+        sin = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(sin, z), r), r);
+
+        __m256 cos{_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(COS_C0), z), _mm256_set1_ps(COS_C1))};
+        cos = _mm256_add_ps(_mm256_mul_ps(cos, z), _mm256_set1_ps(COS_C2));
+        cos = _mm256_sub_ps(_mm256_mul_ps(_mm256_mul_ps(cos, z), z), _mm256_mul_ps(_mm256_set1_ps(.5f), z));
+        cos = _mm256_add_ps(cos, _mm256_set1_ps(1.f));
+
+        // Quadrants 1 and 3 swap sin and cos, sin is negative in 2 and 3, cos in 1 and 2
+        const __m256i one{_mm256_set1_epi32(1)};
+        const __m256i two{_mm256_set1_epi32(2)};
+        const __m256 isSwapped{_mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(quadrant, one), one))};
+        const __m256 isSinNegative{_mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(quadrant, two), two))};
+        const __m256 isCosNegative{
+            _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(_mm256_add_epi32(quadrant, one), two), two))};
+
+        const __m256 signBit{_mm256_set1_ps(-0.f)};
+        outSin = _mm256_xor_ps(_mm256_blendv_ps(sin, cos, isSwapped), _mm256_and_ps(isSinNegative, signBit));
+        outCos = _mm256_xor_ps(_mm256_blendv_ps(cos, sin, isSwapped), _mm256_and_ps(isCosNegative, signBit));
+    }
+
+    VMV_TARGET_AVX2 void StoreColumnAvx2(float* pFirst, size_t validCount, __m256 x, __m256 y, __m256 z, __m256 w)
+    {
+        // 4x4 transposes within both 128 bit halves, the low half holds transforms 0-3, the high half 4-7
+        const __m256 xy0{_mm256_unpacklo_ps(x, y)};
+        const __m256 xy1{_mm256_unpackhi_ps(x, y)};
+        const __m256 zw0{_mm256_unpacklo_ps(z, w)};
+        const __m256 zw1{_mm256_unpackhi_ps(z, w)};
+        const __m256 columns04{_mm256_shuffle_ps(xy0, zw0, 0x44)};
+        const __m256 columns15{_mm256_shuffle_ps(xy0, zw0, 0xEE)};
+        const __m256 columns26{_mm256_shuffle_ps(xy1, zw1, 0x44)};
+        const __m256 columns37{_mm256_shuffle_ps(xy1, zw1, 0xEE)};
+
+        if (validCount == 8)
+        {
+            _mm_storeu_ps(pFirst, _mm256_castps256_ps128(columns04));
+            _mm_storeu_ps(pFirst + FLOATS_PER_MATRICES, _mm256_castps256_ps128(columns15));
+            _mm_storeu_ps(pFirst + 2 * FLOATS_PER_MATRICES, _mm256_castps256_ps128(columns26));
+            _mm_storeu_ps(pFirst + 3 * FLOATS_PER_MATRICES, _mm256_castps256_ps128(columns37));
+            _mm_storeu_ps(pFirst + 4 * FLOATS_PER_MATRICES, _mm256_extractf128_ps(columns04, 1));
+            _mm_storeu_ps(pFirst + 5 * FLOATS_PER_MATRICES, _mm256_extractf128_ps(columns15, 1));
+            _mm_storeu_ps(pFirst + 6 * FLOATS_PER_MATRICES, _mm256_extractf128_ps(columns26, 1));
+            _mm_storeu_ps(pFirst + 7 * FLOATS_PER_MATRICES, _mm256_extractf128_ps(columns37, 1));
+            return;
+        }
+
+        const __m128 columns[8]{_mm256_castps256_ps128(columns04),
+                                _mm256_castps256_ps128(columns15),
+                                _mm256_castps256_ps128(columns26),
+                                _mm256_castps256_ps128(columns37),
+                                _mm256_extractf128_ps(columns04, 1),
+                                _mm256_extractf128_ps(columns15, 1),
+                                _mm256_extractf128_ps(columns26, 1),
+                                _mm256_extractf128_ps(columns37, 1)};
+        for (size_t lane{}; lane < validCount; ++lane)
+        {
+            _mm_storeu_ps(pFirst + lane * FLOATS_PER_MATRICES, columns[lane]);
+        }
+    }
+#endif
+} // namespace
+
+void vmv::VMVTransformBatch::Resize(size_t count)
+{
+    m_Count = count;
+
+    // Padding is an identity transform, so the SIMD loops never divide by a zero scale
+    const size_t paddedCount{(count + LANE_COUNT - 1) / LANE_COUNT * LANE_COUNT};
+    for (Vec3Array* pArray : {&m_Translations, &m_Rotations, &m_Scales})
+    {
+        const float padding{pArray == &m_Scales ? 1.f : 0.f};
+        pArray->x.resize(paddedCount, padding);
+        pArray->y.resize(paddedCount, padding);
+        pArray->z.resize(paddedCount, padding);
+    }
+}
+
+void vmv::VMVTransformBatch::SetTransform(size_t index, const Transform& transform)
+{
+    assert(index < m_Count && "Transform index out of range!");
+    const auto set{[index](Vec3Array& array, const glm::vec3& value) {
+        array.x[index] = value.x;
+        array.y[index] = value.y;
+        array.z[index] = value.z;
+    }};
+    set(m_Translations, transform.GetTranslation());
+    set(m_Rotations, transform.GetRotation());
+    set(m_Scales, transform.GetScale());
+}
+
+void vmv::VMVTransformBatch::Compute(Matrices* pOut) const
+{
+    static const Implementation bestImplementation{GetBestImplementation()};
+    Compute(pOut, bestImplementation);
+}
+
+void vmv::VMVTransformBatch::Compute(Matrices* pOut, Implementation implementation) const
+{
+    switch (IsSupported(implementation) ? implementation : Implementation::Scalar)
+    {
+    case Implementation::Scalar:
+        ComputeScalar(pOut);
+        break;
+    case Implementation::Sse:
+        ComputeSse(pOut);
+        break;
+    case Implementation::Avx2:
+        ComputeAvx2(pOut);
+        break;
+    }
+}
+
+vmv::VMVTransformBatch::Implementation vmv::VMVTransformBatch::GetBestImplementation()
+{
+    if (IsSupported(Implementation::Avx2))
+        return Implementation::Avx2;
+    if (IsSupported(Implementation::Sse))
+        return Implementation::Sse;
+    return Implementation::Scalar;
+}
+
+bool vmv::VMVTransformBatch::IsSupported(Implementation implementation)
+{
+    switch (implementation)
+    {
+    case Implementation::Scalar:
+        return true;
+#if defined(VMV_X86_SIMD)
+    case Implementation::Sse:
+        return true;
+    case Implementation::Avx2:
+        return isAvx2Supported();
+#endif
+    default:
+        return false;
+    }
+}
+
+const char* vmv::VMVTransformBatch::GetImplementationName(Implementation implementation)
+{
+    switch (implementation)
+    {
+    case Implementation::Scalar:
+        return "scalar";
+    case Implementation::Sse:
+        return "SSE";
+    case Implementation::Avx2:
+        return "AVX2";
+    }
+    return "unknown";
+}
+
+void vmv::VMVTransformBatch::ComputeScalar(Matrices* pOut) const
+{
+    for (size_t i{}; i < m_Count; ++i)
+    {
+        const float c3{std::cos(m_Rotations.z[i])};
+        const float s3{std::sin(m_Rotations.z[i])};
+        const float c2{std::cos(m_Rotations.x[i])};
+        const float s2{std::sin(m_Rotations.x[i])};
+        const float c1{std::cos(m_Rotations.y[i])};
+        const float s1{std::sin(m_Rotations.y[i])};
+
+        // Rotation basis, see Transform::UpdateMatrices
+        const glm::vec3 x{c1 * c3 + s1 * s2 * s3, c2 * s3, c1 * s2 * s3 - c3 * s1};
+        const glm::vec3 y{c3 * s1 * s2 - c1 * s3, c2 * c3, c1 * c3 * s2 + s1 * s3};
+        const glm::vec3 z{c2 * s1, -s2, c1 * c2};
+
+        const glm::vec3 scale{m_Scales.x[i], m_Scales.y[i], m_Scales.z[i]};
+        const glm::vec3 invScale{1.f / scale};
+
+        pOut[i].model = glm::mat4{glm::vec4{scale.x * x, 0.f},
+                                  glm::vec4{scale.y * y, 0.f},
+                                  glm::vec4{scale.z * z, 0.f},
+                                  glm::vec4{m_Translations.x[i], m_Translations.y[i], m_Translations.z[i], 1.f}};
+        pOut[i].normalMatrix = glm::mat4{glm::vec4{invScale.x * x, 0.f},
+                                         glm::vec4{invScale.y * y, 0.f},
+                                         glm::vec4{invScale.z * z, 0.f},
+                                         glm::vec4{0.f, 0.f, 0.f, 1.f}};
+    }
+}
+
+void vmv::VMVTransformBatch::ComputeSse(Matrices* pOut) const
+{
+#if defined(VMV_X86_SIMD)
+    float* pFloats{reinterpret_cast<float*>(pOut)};
+    const __m128 zero{_mm_setzero_ps()};
+    const __m128 one{_mm_set1_ps(1.f)};
+    for (size_t i{}; i < m_Count; i += 4)
+    {
+        __m128 s1{}, c1{}, s2{}, c2{}, s3{}, c3{};
+        SinCosSse(_mm_loadu_ps(m_Rotations.y.data() + i), s1, c1);
+        SinCosSse(_mm_loadu_ps(m_Rotations.x.data() + i), s2, c2);
+        SinCosSse(_mm_loadu_ps(m_Rotations.z.data() + i), s3, c3);
+
+        const __m128 s1s2{_mm_mul_ps(s1, s2)};
+        const __m128 c1s2{_mm_mul_ps(c1, s2)};
+        const __m128 xX{_mm_add_ps(_mm_mul_ps(c1, c3), _mm_mul_ps(s1s2, s3))};
+        const __m128 xY{_mm_mul_ps(c2, s3)};
+        const __m128 xZ{_mm_sub_ps(_mm_mul_ps(c1s2, s3), _mm_mul_ps(c3, s1))};
+        const __m128 yX{_mm_sub_ps(_mm_mul_ps(c3, s1s2), _mm_mul_ps(c1, s3))};
+        const __m128 yY{_mm_mul_ps(c2, c3)};
+        const __m128 yZ{_mm_add_ps(_mm_mul_ps(c1s2, c3), _mm_mul_ps(s1, s3))};
+        const __m128 zX{_mm_mul_ps(c2, s1)};
+        const __m128 zY{_mm_sub_ps(zero, s2)};
+        const __m128 zZ{_mm_mul_ps(c1, c2)};
+
+        const __m128 scaleX{_mm_loadu_ps(m_Scales.x.data() + i)};
+        const __m128 scaleY{_mm_loadu_ps(m_Scales.y.data() + i)};
+        const __m128 scaleZ{_mm_loadu_ps(m_Scales.z.data() + i)};
+        const __m128 invScaleX{_mm_div_ps(one, scaleX)};
+        const __m128 invScaleY{_mm_div_ps(one, scaleY)};
+        const __m128 invScaleZ{_mm_div_ps(one, scaleZ)};
+
+        float* pFirst{pFloats + i * FLOATS_PER_MATRICES};
+        const size_t validCount{std::min<size_t>(4, m_Count - i)};
+        StoreColumnSse(pFirst,
+                       validCount,
+                       _mm_mul_ps(scaleX, xX),
+                       _mm_mul_ps(scaleX, xY),
+                       _mm_mul_ps(scaleX, xZ),
+                       zero);
+        StoreColumnSse(pFirst + 4,
+                       validCount,
+                       _mm_mul_ps(scaleY, yX),
+                       _mm_mul_ps(scaleY, yY),
+                       _mm_mul_ps(scaleY, yZ),
+                       zero);
+        StoreColumnSse(pFirst + 8,
+                       validCount,
+                       _mm_mul_ps(scaleZ, zX),
+                       _mm_mul_ps(scaleZ, zY),
+                       _mm_mul_ps(scaleZ, zZ),
+                       zero);
+        StoreColumnSse(pFirst + 12,
+                       validCount,
+                       _mm_loadu_ps(m_Translations.x.data() + i),
+                       _mm_loadu_ps(m_Translations.y.data() + i),
+                       _mm_loadu_ps(m_Translations.z.data() + i),
+                       one);
+
+        float* pNormal{pFirst + NORMAL_MATRIX_OFFSET};
+        StoreColumnSse(pNormal,
+                       validCount,
+                       _mm_mul_ps(invScaleX, xX),
+                       _mm_mul_ps(invScaleX, xY),
+                       _mm_mul_ps(invScaleX, xZ),
+                       zero);
+        StoreColumnSse(pNormal + 4,
+                       validCount,
+                       _mm_mul_ps(invScaleY, yX),
+                       _mm_mul_ps(invScaleY, yY),
+                       _mm_mul_ps(invScaleY, yZ),
+                       zero);
+        StoreColumnSse(pNormal + 8,
+                       validCount,
+                       _mm_mul_ps(invScaleZ, zX),
+                       _mm_mul_ps(invScaleZ, zY),
+                       _mm_mul_ps(invScaleZ, zZ),
+                       zero);
+        StoreColumnSse(pNormal + 12, validCount, zero, zero, zero, one);
+    }
+#else
+    ComputeScalar(pOut);
+#endif
+}
+
+VMV_TARGET_AVX2 void vmv::VMVTransformBatch::ComputeAvx2(Matrices* pOut) const
+{
+#if defined(VMV_X86_SIMD)
+    float* pFloats{reinterpret_cast<float*>(pOut)};
+    const __m256 zero{_mm256_setzero_ps()};
+    const __m256 one{_mm256_set1_ps(1.f)};
+    for (size_t i{}; i < m_Count; i += 8)
+    {
+        __m256 s1{}, c1{}, s2{}, c2{}, s3{}, c3{};
+        SinCosAvx2(_mm256_loadu_ps(m_Rotations.y.data() + i), s1, c1);
+        SinCosAvx2(_mm256_loadu_ps(m_Rotations.x.data() + i), s2, c2);
+        SinCosAvx2(_mm256_loadu_ps(m_Rotations.z.data() + i), s3, c3);
+
+        const __m256 s1s2{_mm256_mul_ps(s1, s2)};
+        const __m256 c1s2{_mm256_mul_ps(c1, s2)};
+        const __m256 xX{_mm256_add_ps(_mm256_mul_ps(c1, c3), _mm256_mul_ps(s1s2, s3))};
+        const __m256 xY{_mm256_mul_ps(c2, s3)};
+        const __m256 xZ{_mm256_sub_ps(_mm256_mul_ps(c1s2, s3), _mm256_mul_ps(c3, s1))};
+        const __m256 yX{_mm256_sub_ps(_mm256_mul_ps(c3, s1s2), _mm256_mul_ps(c1, s3))};
+        const __m256 yY{_mm256_mul_ps(c2, c3)};
+        const __m256 yZ{_mm256_add_ps(_mm256_mul_ps(c1s2, c3), _mm256_mul_ps(s1, s3))};
+        const __m256 zX{_mm256_mul_ps(c2, s1)};
+        const __m256 zY{_mm256_sub_ps(zero, s2)};
+        const __m256 zZ{_mm256_mul_ps(c1, c2)};
+
+        const __m256 scaleX{_mm256_loadu_ps(m_Scales.x.data() + i)};
+        const __m256 scaleY{_mm256_loadu_ps(m_Scales.y.data() + i)};
+        const __m256 scaleZ{_mm256_loadu_ps(m_Scales.z.data() + i)};
+        const __m256 invScaleX{_mm256_div_ps(one, scaleX)};
+        const __m256 invScaleY{_mm256_div_ps(one, scaleY)};
+        const __m256 invScaleZ{_mm256_div_ps(one, scaleZ)};
+
+        float* pFirst{pFloats + i * FLOATS_PER_MATRICES};
+        const size_t validCount{std::min<size_t>(8, m_Count - i)};
+        StoreColumnAvx2(pFirst,
+                        validCount,
+                        _mm256_mul_ps(scaleX, xX),
+                        _mm256_mul_ps(scaleX, xY),
+                        _mm256_mul_ps(scaleX, xZ),
+                        zero);
+        StoreColumnAvx2(pFirst + 4,
+                        validCount,
+                        _mm256_mul_ps(scaleY, yX),
+                        _mm256_mul_ps(scaleY, yY),
+                        _mm256_mul_ps(scaleY, yZ),
+                        zero);
+        StoreColumnAvx2(pFirst + 8,
+                        validCount,
+                        _mm256_mul_ps(scaleZ, zX),
+                        _mm256_mul_ps(scaleZ, zY),
+                        _mm256_mul_ps(scaleZ, zZ),
+                        zero);
+        StoreColumnAvx2(pFirst + 12,
+                        validCount,
+                        _mm256_loadu_ps(m_Translations.x.data() + i),
+                        _mm256_loadu_ps(m_Translations.y.data() + i),
+                        _mm256_loadu_ps(m_Translations.z.data() + i),
+                        one);
+
+        float* pNormal{pFirst + NORMAL_MATRIX_OFFSET};
+        StoreColumnAvx2(pNormal,
+                        validCount,
+                        _mm256_mul_ps(invScaleX, xX),
+                        _mm256_mul_ps(invScaleX, xY),
+                        _mm256_mul_ps(invScaleX, xZ),
+                        zero);
+        StoreColumnAvx2(pNormal + 4,
+                        validCount,
+                        _mm256_mul_ps(invScaleY, yX),
+                        _mm256_mul_ps(invScaleY, yY),
+                        _mm256_mul_ps(invScaleY, yZ),
+                        zero);
+        StoreColumnAvx2(pNormal + 8,
+                        validCount,
+                        _mm256_mul_ps(invScaleZ, zX),
+                        _mm256_mul_ps(invScaleZ, zY),
+                        _mm256_mul_ps(invScaleZ, zZ),
+                        zero);
+        StoreColumnAvx2(pNormal + 12, validCount, zero, zero, zero, one);
+    }
+#else
+    ComputeScalar(pOut);
+#endif
+}
+
+void vmv::VMVTransformBatch::RunBenchmark(size_t transformCount)
+{
+    constexpr uint32_t ITERATIONS{20};
+    constexpr float TOLERANCE{1e-5f}; // relative for entries above 1
+
+    std::mt19937 random{42};
+    std::uniform_real_distribution<float> position{-100.f, 100.f};
+    std::uniform_real_distribution<float> angle{-2.f * glm::two_pi<float>(), 2.f * glm::two_pi<float>()};
+    std::uniform_real_distribution<float> scale{.1f, 10.f};
+
+    std::vector<Transform> transforms(transformCount);
+    VMVTransformBatch batch{};
+    batch.Resize(transformCount);
+    for (size_t i{}; i < transformCount; ++i)
+    {
+        transforms[i].SetTranslation({position(random), position(random), position(random)});
+        transforms[i].SetRotation({angle(random), angle(random), angle(random)});
+        transforms[i].SetScale({scale(random), scale(random), scale(random)});
+        batch.SetTransform(i, transforms[i]);
+    }
+
+    std::vector<Matrices> matrices(transformCount);
+    float scalarTime{};
+    for (Implementation implementation : {Implementation::Scalar, Implementation::Sse, Implementation::Avx2})
+    {
+        if (!IsSupported(implementation))
+        {
+            std::cout << "Transform batch benchmark: " << GetImplementationName(implementation) << " not supported\n";
+            continue;
+        }
+
+        // One untimed run to fault in the output
+        batch.Compute(matrices.data(), implementation);
+
+        using namespace std::chrono;
+        const time_point start{high_resolution_clock::now()};
+        for (uint32_t i{}; i < ITERATIONS; ++i)
+        {
+            batch.Compute(matrices.data(), implementation);
+        }
+        const float time{duration<float, milliseconds::period>(high_resolution_clock::now() - start).count() /
+                         ITERATIONS};
+
+        if (implementation == Implementation::Scalar)
+        {
+            scalarTime = time;
+        }
+
+        // Compared against the per transform functions the renderer used so far
+        float maxError{};
+        for (size_t i{}; i < transformCount; ++i)
+        {
+            const glm::mat4& model{transforms[i].GetMat()};
+            const glm::mat3& normalMatrix{transforms[i].NormalMatrix()};
+            for (int column{}; column < 4; ++column)
+            {
+                for (int row{}; row < 4; ++row)
+                {
+                    const float expectedNormal{column < 3 && row < 3 ? normalMatrix[column][row]
+                                                                     : (column == 3 && row == 3 ? 1.f : 0.f)};
+                    const float modelError{std::abs(matrices[i].model[column][row] - model[column][row]) /
+                                           std::max(1.f, std::abs(model[column][row]))};
+                    const float normalError{std::abs(matrices[i].normalMatrix[column][row] - expectedNormal) /
+                                            std::max(1.f, std::abs(expectedNormal))};
+                    maxError = std::max({maxError, modelError, normalError});
+                }
+            }
+        }
+
+        std::cout << "Transform batch benchmark: " << GetImplementationName(implementation) << ", " << transformCount
+                  << " transforms in " << time << "ms (" << static_cast<float>(transformCount) / time / 1000.f
+                  << "M transforms/s, " << scalarTime / time << "x scalar), max error " << maxError
+                  << (maxError <= TOLERANCE ? "" : " EXCEEDS TOLERANCE") << '\n';
+    }
+}
@@ -0,0 +1,69 @@
+#ifndef VMV_VMVTRANSFORMBATCH_H
+#define VMV_VMVTRANSFORMBATCH_H
+
+#include "VMVGameObject.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace vmv
+{
+    // Computes the model and normal matrices of many transforms at once, 4 (SSE) or 8 (AVX2) at a time with a
+    // vectorized sincos. Same math as Transform::GetMat and Transform::NormalMatrix, for scenes where too many
+    // objects move every frame for the per transform cache to help.
+    class VMVTransformBatch final
+    {
+      public:
+        enum class Implementation
+        {
+            Scalar,
+            Sse,
+            Avx2 // needs 256 bit integer ops for the sincos quadrants, plain AVX has none
+        };
+
+        // Same layout as SimpleRenderSystem::InstanceData, so the output can go straight into the instance buffer
+        struct Matrices
+        {
+            glm::mat4 model{1.f};
+            glm::mat4 normalMatrix{1.f};
+        };
+
+        void Resize(size_t count);
+        void SetTransform(size_t index, const Transform& transform);
+        size_t GetCount() const { return m_Count; }
+
+        // Writes GetCount() matrices to pOut, which doesn't have to be aligned
+        void Compute(Matrices* pOut) const;
+        void Compute(Matrices* pOut, Implementation implementation) const;
+
+        // Fastest implementation this build and CPU support
+        static Implementation GetBestImplementation();
+        static bool IsSupported(Implementation implementation);
+        static const char* GetImplementationName(Implementation implementation);
+
+        // Computes transformCount random transforms with every supported implementation, logs the throughput and
+        // the largest difference to Transform::GetMat / Transform::NormalMatrix
+        static void RunBenchmark(size_t transformCount);
+
+      private:
+        static constexpr size_t LANE_COUNT{8}; // widest implementation, arrays are padded to a multiple of it
+
+        struct Vec3Array
+        {
+            std::vector<float> x{};
+            std::vector<float> y{};
+            std::vector<float> z{};
+        };
+
+        Vec3Array m_Translations{};
+        Vec3Array m_Rotations{};
+        Vec3Array m_Scales{};
+        size_t m_Count{};
+
+        void ComputeScalar(Matrices* pOut) const;
+        void ComputeSse(Matrices* pOut) const;
+        void ComputeAvx2(Matrices* pOut) const;
+    };
+} // namespace vmv
+
+#endif
\ No newline at end of file
@@ -0,0 +1,212 @@
+#include "VMVUploadBatch.h"
+
+#include "VMVStagingRing.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+vmv::VMVUploadBatch::VMVUploadBatch(VMVDevice& device) : m_VMVDevice{device} {}
+
+vmv::VMVUploadBatch::~VMVUploadBatch()
+{
+    Wait();
+    ReleaseResources();
+}
+
+void vmv::VMVUploadBatch::Upload(VkBuffer dstBuffer, const void* data, VkDeviceSize size, VkDeviceSize dstOffset)
+{
+    if (m_IsSubmitted)
+        throw std::runtime_error("Cannot add uploads to a submitted batch!");
+
+    if (size == 0)
+        return;
+
+    if (m_CommandBuffer == VK_NULL_HANDLE)
+    {
+        BeginCommandBuffer();
+    }
+
+    VMVStagingRing::Allocation staging{m_VMVDevice.getStagingRing().Allocate(size, STAGING_ALIGNMENT)};
+    if (staging.buffer != VK_NULL_HANDLE)
+    {
+        m_StagingRegions.push_back(staging.regionId);
+    }
+    else
+    {
+        m_StagingBuffers.push_back(std::make_unique<VMVBuffer>(
+            m_VMVDevice,
+            size,
+            1,
+            VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT));
+        m_StagingBuffers.back()->map();
+
+        staging.buffer = m_StagingBuffers.back()->getBuffer();
+        staging.pMapped = m_StagingBuffers.back()->getMappedMemory();
+    }
+
+    std::memcpy(staging.pMapped, data, size);
+
+    VkBufferCopy copyRegion{};
+    copyRegion.srcOffset = staging.offset;
+    copyRegion.dstOffset = dstOffset;
+    copyRegion.size = size;
+    vkCmdCopyBuffer(m_CommandBuffer, staging.buffer, dstBuffer, 1, &copyRegion);
+
+    ++m_UploadCount;
+    m_UploadedBytes += size;
+}
+
+void vmv::VMVUploadBatch::Submit()
+{
+    if (m_IsSubmitted)
+        return;
+
+    m_IsSubmitted = true;
+    if (m_CommandBuffer == VK_NULL_HANDLE)
+    {
+        m_IsComplete = true;
+        return;
+    }
+
+    if (vkEndCommandBuffer(m_CommandBuffer) != VK_SUCCESS)
+        throw std::runtime_error("Failed to record upload command buffer!");
+
+    VkFenceCreateInfo fenceInfo{};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    if (vkCreateFence(m_VMVDevice.device(), &fenceInfo, nullptr, &m_Fence) != VK_SUCCESS)
+        throw std::runtime_error("Failed to create upload fence!");
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &m_CommandBuffer;
+
+    if (vkQueueSubmit(m_VMVDevice.transferQueue(), 1, &submitInfo, m_Fence) != VK_SUCCESS)
+        throw std::runtime_error("Failed to submit upload batch!");
+
+    // Lets the ring reclaim these regions by itself when it runs out of space
+    for (uint64_t regionId : m_StagingRegions)
+    {
+        m_VMVDevice.getStagingRing().Submit(regionId, m_Fence);
+    }
+}
+
+bool vmv::VMVUploadBatch::IsComplete()
+{
+    if (!m_IsComplete && m_Fence != VK_NULL_HANDLE && vkGetFenceStatus(m_VMVDevice.device(), m_Fence) == VK_SUCCESS)
+    {
+        m_IsComplete = true;
+        ReleaseResources();
+    }
+    return m_IsComplete;
+}
+
+void vmv::VMVUploadBatch::Wait()
+{
+    if (!m_IsSubmitted)
+    {
+        Submit();
+    }
+
+    if (!m_IsComplete && m_Fence != VK_NULL_HANDLE)
+    {
+        vkWaitForFences(m_VMVDevice.device(), 1, &m_Fence, VK_TRUE, UINT64_MAX);
+        m_IsComplete = true;
+        ReleaseResources();
+    }
+}
+
+void vmv::VMVUploadBatch::BeginCommandBuffer()
+{
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandPool = m_VMVDevice.getTransferCommandPool();
+    allocInfo.commandBufferCount = 1;
+
+    if (vkAllocateCommandBuffers(m_VMVDevice.device(), &allocInfo, &m_CommandBuffer) != VK_SUCCESS)
+        throw std::runtime_error("Failed to allocate upload command buffer!");
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+    if (vkBeginCommandBuffer(m_CommandBuffer, &beginInfo) != VK_SUCCESS)
+        throw std::runtime_error("Failed to begin upload command buffer!");
+}
+
+void vmv::VMVUploadBatch::ReleaseResources()
+{
+    for (uint64_t regionId : m_StagingRegions)
+    {
+        m_VMVDevice.getStagingRing().Release(regionId);
+    }
+    m_StagingRegions.clear();
+    m_StagingBuffers.clear();
+
+    if (m_Fence != VK_NULL_HANDLE)
+    {
+        vkDestroyFence(m_VMVDevice.device(), m_Fence, nullptr);
+        m_Fence = VK_NULL_HANDLE;
+    }
+
+    if (m_CommandBuffer != VK_NULL_HANDLE)
+    {
+        vkFreeCommandBuffers(m_VMVDevice.device(), m_VMVDevice.getTransferCommandPool(), 1, &m_CommandBuffer);
+        m_CommandBuffer = VK_NULL_HANDLE;
+    }
+}
+
+void vmv::VMVUploadBatch::RunBenchmark(VMVDevice& device, const std::vector<VkDeviceSize>& bufferSizes)
+{
+    if (bufferSizes.empty())
+        return;
+
+    std::vector<std::unique_ptr<VMVBuffer>> buffers{};
+    VkDeviceSize totalSize{};
+    for (VkDeviceSize size : bufferSizes)
+    {
+        buffers.push_back(std::make_unique<VMVBuffer>(device,
+                                                      size,
+                                                      1,
+                                                      VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                                      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT));
+        totalSize += size;
+    }
+    const std::vector<char> data(*std::max_element(bufferSizes.begin(), bufferSizes.end()), 1);
+
+    const auto measure{[&](bool isBatched) {
+        using namespace std::chrono;
+        const time_point start{high_resolution_clock::now()};
+        if (isBatched)
+        {
+            VMVUploadBatch uploadBatch{device};
+            for (size_t i{}; i < buffers.size(); ++i)
+            {
+                uploadBatch.Upload(buffers[i]->getBuffer(), data.data(), bufferSizes[i]);
+            }
+            uploadBatch.Wait();
+        }
+        else
+        {
+            for (size_t i{}; i < buffers.size(); ++i)
+            {
+                VMVUploadBatch uploadBatch{device};
+                uploadBatch.Upload(buffers[i]->getBuffer(), data.data(), bufferSizes[i]);
+                uploadBatch.Wait();
+            }
+        }
+        return duration<float, milliseconds::period>(high_resolution_clock::now() - start).count();
+    }};
+
+    measure(true); // untimed, brings the staging ring and the buffers' memory in
+    const float perBufferTime{measure(false)};
+    const float batchedTime{measure(true)};
+    std::cout << "Benchmark: uploading " << buffers.size() << " buffers, " << totalSize / 1024
+              << " KiB, submit and wait per buffer: " << perBufferTime << "ms, one batch: " << batchedTime << "ms ("
+              << perBufferTime / batchedTime << "x)\n";
+}
@@ -0,0 +1,63 @@
+#ifndef VMV_VMVUPLOADBATCH_H
+#define VMV_VMVUPLOADBATCH_H
+
+#include "VMVBuffer.h"
+#include "VMVDevice.h"
+
+#include <memory>
+#include <vector>
+
+namespace vmv
+{
+    // Records any number of buffer uploads into one command buffer on the transfer queue and submits them
+    // together with a fence, instead of one submit + vkQueueWaitIdle per buffer. Staging memory comes from
+    // the device's VMVStagingRing and is handed back once the fence signals.
+    // Destination buffers must not be used by the GPU before IsComplete() / Wait().
+    class VMVUploadBatch final
+    {
+      public:
+        explicit VMVUploadBatch(VMVDevice& device);
+        ~VMVUploadBatch(); // submits pending uploads and waits for them
+
+        VMVUploadBatch(const VMVUploadBatch&) = delete;
+        VMVUploadBatch(VMVUploadBatch&&) noexcept = delete;
+        VMVUploadBatch& operator=(const VMVUploadBatch&) = delete;
+        VMVUploadBatch& operator=(VMVUploadBatch&&) noexcept = delete;
+
+        // Copies data to staging memory right away, so it may be freed after the call
+        void Upload(VkBuffer dstBuffer, const void* data, VkDeviceSize size, VkDeviceSize dstOffset = 0);
+
+        void Submit();
+        bool IsComplete();
+        void Wait();
+
+        uint32_t GetUploadCount() const { return m_UploadCount; }
+        VkDeviceSize GetUploadedBytes() const { return m_UploadedBytes; }
+
+        // Uploads one device local buffer per size, all in one batch and then with a submit and wait per buffer
+        // as the models did before, and reports the time of both
+        static void RunBenchmark(VMVDevice& device, const std::vector<VkDeviceSize>& bufferSizes);
+
+      private:
+        static constexpr VkDeviceSize STAGING_ALIGNMENT{16};
+
+        VMVDevice& m_VMVDevice;
+
+        VkCommandBuffer m_CommandBuffer{VK_NULL_HANDLE};
+        VkFence m_Fence{VK_NULL_HANDLE};
+        bool m_IsSubmitted{false};
+        bool m_IsComplete{false};
+
+        std::vector<uint64_t> m_StagingRegions{};
+        // Only used for uploads the staging ring could not fit
+        std::vector<std::unique_ptr<VMVBuffer>> m_StagingBuffers{};
+
+        uint32_t m_UploadCount{};
+        VkDeviceSize m_UploadedBytes{};
+
+        void BeginCommandBuffer();
+        void ReleaseResources();
+    };
+} // namespace vmv
+
+#endif
\ No newline at end of file
@@ -1,6 +1,8 @@
 #ifndef VMV_VMVUTILS_H
 #define VMV_VMVUTILS_H
 
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 
 namespace vmv
@@ -11,6 +13,18 @@ namespace vmv
         seed ^= std::hash<T>{}(v) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
         (hashCombine(seed, rest), ...);
     };
+
+    // 64-bit FNV-1a, stable across runs and platforms (unlike std::hash), so it can be written to disk
+    inline uint64_t hashBytes(const void* data, std::size_t size, uint64_t seed = 0xcbf29ce484222325ull)
+    {
+        const unsigned char* bytes{static_cast<const unsigned char*>(data)};
+        for (std::size_t i{}; i < size; ++i)
+        {
+            seed ^= bytes[i];
+            seed *= 0x100000001b3ull;
+        }
+        return seed;
+    }
 } // namespace vmv
 
 #endif
\ No newline at end of file
@@ -14,13 +14,15 @@ void vmv::KeyboardMovementController::MoveInPlaneXZ(GLFWwindow* window, float dt
     if (glfwGetKey(window, keys.lookDown) == GLFW_PRESS)
         rotate.x -= 1.f;
 
+    glm::vec3 rotation{go.m_Transform.GetRotation()};
     if (glm::dot(rotate, rotate) > std::numeric_limits<float>::epsilon())
-        go.m_Transform.rotation += lookSpeed * dt * glm::normalize(rotate);
+        rotation += lookSpeed * dt * glm::normalize(rotate);
 
-    go.m_Transform.rotation.x = glm::clamp(go.m_Transform.rotation.x, -1.5f, 1.5f);
-    go.m_Transform.rotation.y = glm::mod(go.m_Transform.rotation.y, glm::two_pi<float>());
+    rotation.x = glm::clamp(rotation.x, -1.5f, 1.5f);
+    rotation.y = glm::mod(rotation.y, glm::two_pi<float>());
+    go.m_Transform.SetRotation(rotation);
 
-    float yaw{go.m_Transform.rotation.y};
+    float yaw{rotation.y};
     const glm::vec3 forward{std::sinf(yaw), 0.f, std::cosf(yaw)};
     const glm::vec3 right{forward.z, 0.f, -forward.x};
     const glm::vec3 up{0.f, -1.f, 0.f};
@@ -40,5 +42,5 @@ void vmv::KeyboardMovementController::MoveInPlaneXZ(GLFWwindow* window, float dt
         moveDir -= up;
 
     if (glm::dot(moveDir, moveDir) > std::numeric_limits<float>::epsilon())
-        go.m_Transform.translation += moveSpeed * dt * glm::normalize(moveDir);
+        go.m_Transform.SetTranslation(go.m_Transform.GetTranslation() + moveSpeed * dt * glm::normalize(moveDir));
 }
\ No newline at end of file
@@ -0,0 +1,20 @@
+#version 450
+
+// Same as shader_2D.vert, for VMVModel::PackedVertex.
+// push.model already contains the model's dequantize matrix.
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec4 color;
+layout(location = 2) in vec2 normal;
+layout(location = 3) in vec2 uv;
+
+layout(location = 0) out vec3 fragColor;
+
+layout(push_constant) uniform Push {
+	mat4 model;
+} push;
+
+void main()
+{
+	gl_Position = push.model * vec4(position.xyz, 1.0);
+	fragColor = color.rgb;
+}
@@ -0,0 +1,37 @@
+#version 450
+
+// Same as simple_shader.vert, with the transforms read per instance from the instance buffer
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 color;
+layout(location = 2) in vec3 normal;
+layout(location = 3) in vec2 uv;
+
+layout(location = 0) out vec3 fragColor;
+
+layout(binding = 0) uniform UniformBufferObject {
+    mat4 view;
+    mat4 proj;
+} globalUbo;
+
+struct InstanceData {
+	mat4 model;
+	mat4 normalMatrix;
+};
+
+layout(std430, binding = 1) readonly buffer InstanceBuffer {
+	InstanceData instances[];
+};
+
+const vec3 DIRECTION_TO_LIGHT = normalize(vec3(1.0, -3.0, -1.0));
+const float AMBIENT = 0.1;
+
+void main()
+{
+	InstanceData instance = instances[gl_InstanceIndex];
+	gl_Position = (globalUbo.proj * globalUbo.view * instance.model) * vec4(position, 1.0);
+
+	// Simple lambertian diffuse
+	vec3 normalWorldSpace = normalize(mat3(instance.normalMatrix) * normal);
+	float lightIntensity = AMBIENT + max(dot(normalWorldSpace, DIRECTION_TO_LIGHT), 0);
+	fragColor = lightIntensity * color;
+}
\ No newline at end of file
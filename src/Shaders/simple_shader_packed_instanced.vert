@@ -0,0 +1,47 @@
+#version 450
+
+// Same as simple_shader_packed.vert, with the transforms read per instance from the instance buffer.
+// The instance model matrix already contains the model's dequantize matrix.
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec4 color;
+layout(location = 2) in vec2 normal;
+layout(location = 3) in vec2 uv;
+
+layout(location = 0) out vec3 fragColor;
+
+layout(binding = 0) uniform UniformBufferObject {
+    mat4 view;
+    mat4 proj;
+} globalUbo;
+
+struct InstanceData {
+	mat4 model;
+	mat4 normalMatrix;
+};
+
+layout(std430, binding = 1) readonly buffer InstanceBuffer {
+	InstanceData instances[];
+};
+
+const vec3 DIRECTION_TO_LIGHT = normalize(vec3(1.0, -3.0, -1.0));
+const float AMBIENT = 0.1;
+
+vec3 OctahedralDecode(vec2 e)
+{
+	vec3 n = vec3(e.xy, 1.0 - abs(e.x) - abs(e.y));
+	float t = max(-n.z, 0.0);
+	n.x += n.x >= 0.0 ? -t : t;
+	n.y += n.y >= 0.0 ? -t : t;
+	return normalize(n);
+}
+
+void main()
+{
+	InstanceData instance = instances[gl_InstanceIndex];
+	gl_Position = (globalUbo.proj * globalUbo.view * instance.model) * vec4(position.xyz, 1.0);
+
+	// Simple lambertian diffuse
+	vec3 normalWorldSpace = normalize(mat3(instance.normalMatrix) * OctahedralDecode(normal));
+	float lightIntensity = AMBIENT + max(dot(normalWorldSpace, DIRECTION_TO_LIGHT), 0);
+	fragColor = lightIntensity * color.rgb;
+}
\ No newline at end of file
@@ -1,13 +1,23 @@
 #include "VecmathVisualizer.h"
 #include <array>
 #include <chrono>
+#include <cmath>
+#include <iostream>
 #include <stdexcept>
+#include <thread>
+#include <utility>
 
 #include "Core/SimpleRenderSystem.h"
 #include "Core/RenderSystem2D.h"
 #include "Core/VMVBuffer.h"
 #include "Core/VMVFrameInfo.h"
+#include "Core/VMVFramePacer.h"
+#include "Core/VMVGeometryPool.h"
 #include "Core/VMVModel.h"
+#include "Core/VMVPipelineLibrary.h"
+#include "Core/VMVStagingRing.h"
+#include "Core/VMVThreadPool.h"
+#include "Core/VMVUploadBatch.h"
 #include "KeyboardMovementController.h"
 
 #define GLM_FORCE_RADIANS
@@ -16,7 +26,7 @@
 
 vmv::VecmathVisualizer::VecmathVisualizer()
 {
-    LoadGameObjects();
+    LoadScene();
 }
 
 vmv::VecmathVisualizer::~VecmathVisualizer() {}
@@ -31,18 +41,84 @@ void vmv::VecmathVisualizer::Run()
 
     KeyboardMovementController input{};
 
+    VMVThreadPool threadPool{};
+    m_VMVRenderer.CreateSecondaryCommandPools(threadPool.GetThreadCount());
+    bool isParallelRecording{false};
+    bool wasParallelRecordingKeyDown{false};
+    bool wasLatencyModeKeyDown{false};
+    bool wasFramesInFlightKeyDown{false};
+    bool wasDrawSortingKeyDown{false};
+
+    VMVFramePacer framePacer{m_VMVRenderer};
+    size_t frameRateLimitIndex{};
+    bool wasFrameRateLimitKeyDown{false};
+
+    // True once per key press
+    const auto isKeyPressed{[this](int key, bool& wasKeyDown) {
+        const bool isKeyDown{glfwGetKey(m_VMVWindow.GetWindow(), key) == GLFW_PRESS};
+        const bool isPressed{isKeyDown && !wasKeyDown};
+        wasKeyDown = isKeyDown;
+        return isPressed;
+    }};
+    const auto logSwapChainSettings{[this]() {
+        std::cout << "Latency mode: " << VMVSwapChain::getLatencyModeName(m_VMVRenderer.GetLatencyMode()) << " ("
+                  << VMVSwapChain::getPresentModeName(m_VMVRenderer.GetPresentMode()) << ", "
+                  << m_VMVRenderer.GetFramesInFlight() << " frames in flight)\n";
+    }};
+    logSwapChainSettings();
+
     using namespace std::chrono;
     time_point currentTime{high_resolution_clock::now()};
 
+    bool isFirstFrame{true};
+    bool arePipelinesReady{false};
+
+    VMVFrameStats accumulatedStats{};
+    uint32_t accumulatedFrames{};
+    float accumulatedInputLatency{};
+    float statsTimer{};
+
     while (!m_VMVWindow.ShouldClose())
     {
+        // Wait for the GPU before sampling input, not in BeginFrame after it
+        framePacer.WaitForNextFrame();
         glfwPollEvents();
         time_point newTime{high_resolution_clock::now()};
         float frameTime{duration<float, seconds::period>(newTime - currentTime).count()};
         currentTime = newTime;
 
         input.MoveInPlaneXZ(m_VMVWindow.GetWindow(), frameTime, viewer);
-        camera.SetViewEuler(viewer.m_Transform.translation, viewer.m_Transform.rotation);
+
+        if (isKeyPressed(PARALLEL_RECORDING_KEY, wasParallelRecordingKeyDown))
+        {
+            isParallelRecording = !isParallelRecording;
+            std::cout << "Parallel recording " << (isParallelRecording ? "on" : "off") << " ("
+                      << threadPool.GetThreadCount() << " threads)\n";
+        }
+        if (isKeyPressed(LATENCY_MODE_KEY, wasLatencyModeKeyDown))
+        {
+            const int nextMode{(static_cast<int>(m_VMVRenderer.GetLatencyMode()) + 1) %
+                               (static_cast<int>(VMVSwapChain::LatencyMode::Uncapped) + 1)};
+            m_VMVRenderer.SetLatencyMode(static_cast<VMVSwapChain::LatencyMode>(nextMode));
+            logSwapChainSettings();
+        }
+        if (isKeyPressed(FRAMES_IN_FLIGHT_KEY, wasFramesInFlightKeyDown))
+        {
+            m_VMVRenderer.SetFramesInFlight(m_VMVRenderer.GetFramesInFlight() % VMVSwapChain::MAX_FRAMES_IN_FLIGHT + 1);
+            logSwapChainSettings();
+        }
+        if (isKeyPressed(FRAME_RATE_LIMIT_KEY, wasFrameRateLimitKeyDown))
+        {
+            frameRateLimitIndex = (frameRateLimitIndex + 1) % FRAME_RATE_LIMITS.size();
+            framePacer.SetFrameRateLimit(FRAME_RATE_LIMITS[frameRateLimitIndex]);
+            std::cout << "Frame rate limit: " << FRAME_RATE_LIMITS[frameRateLimitIndex] << " fps (0 is off)\n";
+        }
+        if (isKeyPressed(DRAW_SORTING_KEY, wasDrawSortingKeyDown))
+        {
+            renderSystem.SetDrawSorting(!renderSystem.IsSortingDraws());
+            std::cout << "Draw sorting " << (renderSystem.IsSortingDraws() ? "on" : "off") << '\n';
+        }
+        camera.SetViewEuler(viewer.m_Transform.GetTranslation(), viewer.m_Transform.GetRotation());
 
         float aspect{m_VMVRenderer.GetAspectRatio()};
         // camera.SetOrthographicProjection(-aspect, aspect, -1, 1, -1, 1);
@@ -54,42 +130,384 @@ void vmv::VecmathVisualizer::Run()
             VMVFrameInfo frameInfo{frameIndex, frameTime, commandBuffer, camera};
 
             // render
-            m_VMVRenderer.BeginSwapChainRenderPass(commandBuffer);
-            renderSystem2D.DrawGameObjects(frameInfo, m_GameObjects2D);
-            renderSystem.DrawGameObjects(frameInfo, m_GameObjects);
-            m_VMVRenderer.EndSwapChainRenderPass(commandBuffer);
+            RecordScene(
+                frameInfo, renderSystem, &renderSystem2D, m_Scene, isParallelRecording ? &threadPool : nullptr);
+
+            m_VMVRenderer.EndFrame();
+            framePacer.OnFrameSubmitted();
+
+            if (isFirstFrame)
+            {
+                LogStartupTime("First frame");
+                isFirstFrame = false;
+            }
+            // Throws once a pipeline failed to compile instead of drawing without it for good
+            if (!arePipelinesReady && renderSystem.ArePipelinesReady() && renderSystem2D.ArePipelinesReady())
+            {
+                // Drawn with every pipeline from this frame on
+                LogStartupTime("All pipelines ready");
+                arePipelinesReady = true;
+            }
+
+            accumulatedInputLatency += framePacer.GetInputLatency();
+            accumulatedStats.drawCalls += frameInfo.stats.drawCalls;
+            accumulatedStats.drawCommands += frameInfo.stats.drawCommands;
+            accumulatedStats.instances += frameInfo.stats.instances;
+            accumulatedStats.pipelineBinds += frameInfo.stats.pipelineBinds;
+            accumulatedStats.bufferBinds += frameInfo.stats.bufferBinds;
+            accumulatedStats.skippedCommands += frameInfo.stats.skippedCommands;
+            accumulatedStats.visibleObjects += frameInfo.stats.visibleObjects;
+            accumulatedStats.culledObjects += frameInfo.stats.culledObjects;
+            accumulatedStats.recordTime += frameInfo.stats.recordTime;
+            ++accumulatedFrames;
+        }
+
+        statsTimer += frameTime;
+        if (statsTimer >= STATS_LOG_INTERVAL && accumulatedFrames > 0)
+        {
+            const float frames{static_cast<float>(accumulatedFrames)};
+            std::cout << "Frame: " << accumulatedStats.drawCalls / accumulatedFrames << " draw calls ("
+                      << accumulatedStats.drawCommands / accumulatedFrames << " draws), "
+                      << accumulatedStats.instances / accumulatedFrames << " instances ("
+                      << accumulatedStats.visibleObjects / accumulatedFrames << " visible, "
+                      << accumulatedStats.culledObjects / accumulatedFrames << " culled), "
+                      << accumulatedStats.pipelineBinds / accumulatedFrames << " pipeline binds, "
+                      << accumulatedStats.bufferBinds / accumulatedFrames << " buffer binds ("
+                      << accumulatedStats.skippedCommands / accumulatedFrames << " redundant commands skipped), "
+                      << accumulatedStats.recordTime / frames << "ms recording, " << statsTimer * 1000.f / frames
+                      << "ms frame time, " << accumulatedInputLatency / frames << "ms input to submit\n";
+
+            accumulatedStats = {};
+            accumulatedInputLatency = 0.f;
+            accumulatedFrames = 0;
+            statsTimer = 0.f;
+        }
+    }
+
+    vkDeviceWaitIdle(m_VMVDevice.device());
+}
+
+void vmv::VecmathVisualizer::RunSceneBenchmark() const
+{
+    VMVScene::RunBenchmark(1'000'000, m_Scene);
+}
+
+void vmv::VecmathVisualizer::RunBenchmark()
+{
+    constexpr uint32_t WARMUP_FRAMES{20};
+    constexpr uint32_t MEASURED_FRAMES{200};
+    constexpr std::array<uint32_t, 3> OBJECT_COUNTS{1'000, 10'000, 100'000};
+    constexpr std::array<std::pair<SimpleRenderSystem::DrawMode, const char*>, 3> DRAW_MODES{{
+        {SimpleRenderSystem::DrawMode::PerObject, "per object"},
+        {SimpleRenderSystem::DrawMode::Instanced, "instanced"},
+        {SimpleRenderSystem::DrawMode::Indirect, "indirect"},
+    }};
+    constexpr uint32_t SORTING_OBJECT_COUNT{10'000};
+    constexpr uint32_t SCALING_OBJECT_COUNT{100'000};
+    constexpr uint32_t FORMAT_OBJECT_COUNT{100'000};
+    constexpr uint32_t UPLOAD_REPEAT{16};
+    constexpr std::array<std::pair<VMVModel::VertexFormat, const char*>, 2> VERTEX_FORMATS{{
+        {VMVModel::VertexFormat::Full, "full"},
+        {VMVModel::VertexFormat::Packed, "packed"},
+    }};
+
+    // The geometry of the loaded scenes, as if every model was loaded UPLOAD_REPEAT times
+    std::vector<VkDeviceSize> uploadSizes{};
+    for (const VMVScene* pScene : {&m_Scene, &m_Scene2D})
+    {
+        for (VMVScene::ModelId modelId{}; modelId < pScene->GetModelCount(); ++modelId)
+        {
+            const VMVModel::Stats modelStats{pScene->GetModel(modelId).GetStats()};
+            for (uint32_t i{}; i < UPLOAD_REPEAT; ++i)
+            {
+                uploadSizes.push_back(modelStats.vertexBufferSize);
+                uploadSizes.push_back(modelStats.indexBufferSize);
+            }
+        }
+    }
+    std::erase(uploadSizes, VkDeviceSize{0});
+    VMVUploadBatch::RunBenchmark(m_VMVDevice, uploadSizes);
+
+    SimpleRenderSystem renderSystem{m_VMVDevice, m_VMVRenderer.GetSwapChainRenderPass()};
+    renderSystem.WaitForPipelines(); // nothing would be drawn until they are
+
+    VMVCamera camera{};
+    camera.SetViewEuler({0.f, 0.f, -5.f}, {0.f, 0.f, 0.f});
+    camera.SetPerspectiveProjection(glm::radians(50.f), m_VMVRenderer.GetAspectRatio(), .1f, 100.f);
+
+    // Square grid of objects cycling through the models of the scene
+    const auto fillGrid{[](VMVScene& scene, uint32_t objectCount) {
+        const VMVScene::ModelId modelCount{static_cast<VMVScene::ModelId>(scene.GetModelCount())};
+        scene.Reserve(objectCount);
+        const uint32_t side{static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<float>(objectCount))))};
+        for (uint32_t i{}; i < objectCount; ++i)
+        {
+            Transform transform{};
+            transform.SetTranslation({static_cast<float>(i % side) / side * 8.f - 4.f,
+                                      static_cast<float>(i / side) / side * 8.f - 4.f,
+                                      10.f});
+            transform.SetScale({.1f, .1f, .1f});
+            scene.CreateEntity(i % modelCount, transform);
+        }
+    }};
+
+    // One shared model by default, so the instanced paths can batch everything. With more models the objects
+    // cycle through the loaded ones, which differ in pipeline and buffers.
+    const auto createGrid{[this, &fillGrid](uint32_t objectCount, VMVScene::ModelId modelCount = 1) {
+        VMVScene scene{};
+        for (VMVScene::ModelId modelId{}; modelId < modelCount; ++modelId)
+        {
+            scene.AddModel(m_Scene.GetSharedModel(modelId % m_Scene.GetModelCount()));
+        }
+        fillGrid(scene, objectCount);
+        return scene;
+    }};
+
+    struct BenchmarkResult
+    {
+        VMVFrameStats stats{};     // recordTime averaged, draw calls and binds of the last frame
+        float frameTime{};         // wall time between frames, in ms
+        float commandBufferTime{}; // primary command buffer reset, begin and end, in ms
+    };
+
+    // Averages over the measured frames, nothing if the window was closed
+    const auto measure{[&](VMVScene& scene, VMVThreadPool* pThreadPool) {
+        BenchmarkResult result{};
+        uint32_t measuredFrames{};
+        auto measureStart{std::chrono::high_resolution_clock::now()};
+        for (uint32_t frame{}; frame < WARMUP_FRAMES + MEASURED_FRAMES && !m_VMVWindow.ShouldClose(); ++frame)
+        {
+            if (frame == WARMUP_FRAMES)
+            {
+                measureStart = std::chrono::high_resolution_clock::now();
+            }
 
+            glfwPollEvents();
+            VkCommandBuffer commandBuffer{m_VMVRenderer.BeginFrame()};
+            if (commandBuffer == nullptr)
+                continue;
+
+            VMVFrameInfo frameInfo{m_VMVRenderer.GetFrameIndex(), 0.f, commandBuffer, camera};
+            RecordScene(frameInfo, renderSystem, nullptr, scene, pThreadPool);
             m_VMVRenderer.EndFrame();
+
+            if (frame >= WARMUP_FRAMES)
+            {
+                result.stats.recordTime += frameInfo.stats.recordTime;
+                result.stats.drawCalls = frameInfo.stats.drawCalls;
+                result.stats.pipelineBinds = frameInfo.stats.pipelineBinds;
+                result.stats.bufferBinds = frameInfo.stats.bufferBinds;
+                result.stats.skippedCommands = frameInfo.stats.skippedCommands;
+                result.commandBufferTime += m_VMVRenderer.GetCommandBufferTime();
+                ++measuredFrames;
+            }
+        }
+
+        if (measuredFrames > 0)
+        {
+            const float frames{static_cast<float>(measuredFrames)};
+            result.stats.recordTime /= frames;
+            result.commandBufferTime /= frames;
+            const auto measureTime{std::chrono::high_resolution_clock::now() - measureStart};
+            result.frameTime = std::chrono::duration<float, std::milli>(measureTime).count() / frames;
+        }
+        return std::pair{result, measuredFrames > 0};
+    }};
+
+    for (uint32_t objectCount : OBJECT_COUNTS)
+    {
+        VMVScene scene{createGrid(objectCount)};
+        for (const auto& [drawMode, name] : DRAW_MODES)
+        {
+            renderSystem.SetDrawMode(drawMode);
+            if (const auto [result, isMeasured]{measure(scene, nullptr)}; isMeasured)
+            {
+                std::cout << "Benchmark: " << objectCount << " objects, " << name << ": " << result.stats.recordTime
+                          << "ms recording per frame, " << result.stats.drawCalls << " draw calls, "
+                          << result.frameTime << "ms frame time (" << result.commandBufferTime
+                          << "ms command buffer reset/begin/end)\n";
+            }
+        }
+    }
+
+    // Interleaved models make every unsorted per object draw switch state
+    VMVScene mixedScene{createGrid(SORTING_OBJECT_COUNT, static_cast<VMVScene::ModelId>(m_Scene.GetModelCount()))};
+    for (const auto& [drawMode, name] : DRAW_MODES)
+    {
+        renderSystem.SetDrawMode(drawMode);
+        for (bool isSortingDraws : {false, true})
+        {
+            renderSystem.SetDrawSorting(isSortingDraws);
+            if (const auto [result, isMeasured]{measure(mixedScene, nullptr)}; isMeasured)
+            {
+                std::cout << "Benchmark: " << SORTING_OBJECT_COUNT << " mixed objects, " << name
+                          << (isSortingDraws ? ", sorted: " : ", unsorted: ") << result.stats.recordTime
+                          << "ms recording per frame, " << result.stats.pipelineBinds << " pipeline binds, "
+                          << result.stats.bufferBinds << " buffer binds, " << result.stats.skippedCommands
+                          << " redundant commands skipped, " << result.stats.drawCalls << " draw calls\n";
+            }
+        }
+    }
+    renderSystem.SetDrawSorting(true);
+
+    // The same mesh in both vertex formats, drawn indirect so vertex fetch rather than recording dominates.
+    // Uncapped so the frame time is the GPU's, not the display's.
+    const VMVSwapChain::LatencyMode latencyMode{m_VMVRenderer.GetLatencyMode()};
+    m_VMVRenderer.SetLatencyMode(VMVSwapChain::LatencyMode::Uncapped);
+    renderSystem.SetDrawMode(SimpleRenderSystem::DrawMode::Indirect);
+    for (const auto& [vertexFormat, name] : VERTEX_FORMATS)
+    {
+        VMVScene formatScene{};
+        formatScene.AddModel(VMVModel::CreateModelFromFile(m_VMVDevice, "data/models/smooth_vase.obj", vertexFormat));
+        fillGrid(formatScene, FORMAT_OBJECT_COUNT);
+
+        const VMVModel::Stats modelStats{formatScene.GetModel(0).GetStats()};
+        if (const auto [result, isMeasured]{measure(formatScene, nullptr)}; isMeasured)
+        {
+            std::cout << "Benchmark: " << FORMAT_OBJECT_COUNT << " objects, " << name << " vertices ("
+                      << modelStats.vertexSize << " bytes, " << modelStats.vertexBufferSize / 1024
+                      << " KiB vertex buffer): " << result.stats.recordTime << "ms recording per frame, "
+                      << result.frameTime << "ms frame time\n";
+        }
+
+        // The model's geometry ranges are freed with the scene and reused by the next upload, so the frames still
+        // in flight must be done reading them
+        vkDeviceWaitIdle(m_VMVDevice.device());
+    }
+    m_VMVRenderer.SetLatencyMode(latencyMode);
+
+    // Per object draws are the ones where recording dominates, so they show the scaling best
+    VMVScene scene{createGrid(SCALING_OBJECT_COUNT)};
+    renderSystem.SetDrawMode(SimpleRenderSystem::DrawMode::PerObject);
+    const uint32_t maxThreadCount{std::max(std::thread::hardware_concurrency(), 1u)};
+    float singleThreadTime{};
+    for (uint32_t threadCount{1}; threadCount <= maxThreadCount; threadCount *= 2)
+    {
+        VMVThreadPool threadPool{threadCount};
+        m_VMVRenderer.CreateSecondaryCommandPools(threadCount);
+
+        if (const auto [result, isMeasured]{measure(scene, &threadPool)}; isMeasured)
+        {
+            singleThreadTime = threadCount == 1 ? result.stats.recordTime : singleThreadTime;
+            std::cout << "Benchmark: " << SCALING_OBJECT_COUNT << " objects, per object, " << threadCount
+                      << " recording threads: " << result.stats.recordTime << "ms recording per frame ("
+                      << singleThreadTime / result.stats.recordTime << "x one thread), " << result.frameTime
+                      << "ms frame time\n";
         }
     }
 
     vkDeviceWaitIdle(m_VMVDevice.device());
 }
 
-void vmv::VecmathVisualizer::LoadGameObjects()
+void vmv::VecmathVisualizer::RecordScene(VMVFrameInfo& frameInfo,
+                                         SimpleRenderSystem& renderSystem,
+                                         RenderSystem2D* pRenderSystem2D,
+                                         VMVScene& scene,
+                                         VMVThreadPool* pThreadPool)
 {
-    std::shared_ptr<VMVModel> model{VMVModel::CreateModelFromFile(m_VMVDevice, "data/models/flat_vase.obj")};
-    VMVGameObject gameObject{VMVGameObject::CreateGameObject()};
-    gameObject.m_Model = model;
-    gameObject.m_Transform.translation = {-0.5f, 0.5f, 2.5f};
-    gameObject.m_Transform.scale = {3.f, 3.f, 3.f};
+    // culling dispatches have to be recorded before the render pass
+    renderSystem.PrepareScene(frameInfo, scene);
+
+    if (pThreadPool == nullptr)
+    {
+        m_VMVRenderer.BeginSwapChainRenderPass(frameInfo.commandBuffer);
+        if (pRenderSystem2D != nullptr)
+        {
+            pRenderSystem2D->DrawScene(frameInfo, m_Scene2D);
+        }
+        renderSystem.DrawScene(frameInfo, scene);
+        m_VMVRenderer.EndSwapChainRenderPass(frameInfo.commandBuffer);
+        return;
+    }
+
+    VkCommandBuffer primaryCommandBuffer{frameInfo.commandBuffer};
+    m_VMVRenderer.BeginSwapChainRenderPass(primaryCommandBuffer, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+    m_SecondaryCommandBuffers.clear();
+
+    if (pRenderSystem2D != nullptr)
+    {
+        // A handful of objects, recorded here before the workers start using the first thread's pool
+        frameInfo.commandBuffer = m_VMVRenderer.BeginSecondaryCommandBuffer(0);
+        frameInfo.commandState.Reset(frameInfo.commandBuffer);
+        pRenderSystem2D->DrawScene(frameInfo, m_Scene2D);
+        m_VMVRenderer.EndSecondaryCommandBuffer(frameInfo.commandBuffer);
+        m_SecondaryCommandBuffers.push_back(frameInfo.commandBuffer);
+        frameInfo.commandBuffer = primaryCommandBuffer;
+        frameInfo.commandState.Reset(primaryCommandBuffer);
+    }
+
+    renderSystem.RecordScene(frameInfo, scene, m_VMVRenderer, *pThreadPool, m_SecondaryCommandBuffers);
+    m_VMVRenderer.ExecuteSecondaryCommandBuffers(primaryCommandBuffer, m_SecondaryCommandBuffers);
+    frameInfo.commandState.Reset(primaryCommandBuffer); // the secondaries leave the state undefined
+    m_VMVRenderer.EndSwapChainRenderPass(primaryCommandBuffer);
+}
+
+void vmv::VecmathVisualizer::LogStartupTime(const char* event)
+{
+    using namespace std::chrono;
+    const float startupTime{duration<float, milliseconds::period>(high_resolution_clock::now() - m_StartTime).count()};
+
+    const VMVPipelineLibrary::Stats pipelineStats{m_VMVDevice.getPipelineLibrary().GetStats()};
+    const uint32_t pipelineCount{pipelineStats.requestCount - pipelineStats.deduplicatedCount};
+    std::cout << event << " after " << startupTime << "ms (" << pipelineStats.compiledCount << " of "
+              << pipelineCount << " pipelines compiled, " << pipelineStats.failedCount << " failed, "
+              << pipelineStats.deduplicatedCount << " requests deduplicated)\n";
+}
+
+void vmv::VecmathVisualizer::LoadScene()
+{
+    using namespace std::chrono;
+    const time_point start{high_resolution_clock::now()};
+
+    // All model uploads go out in one submission, waited on once at the end
+    VMVUploadBatch uploadBatch{m_VMVDevice};
+
+    const VMVScene::ModelId model{m_Scene.AddModel(VMVModel::CreateModelFromFile(
+        m_VMVDevice, "data/models/flat_vase.obj", VMVModel::VertexFormat::Full, false, &uploadBatch))};
+    Transform transform{};
+    transform.SetTranslation({-0.5f, 0.5f, 2.5f});
+    transform.SetScale({3.f, 3.f, 3.f});
+
+    m_Scene.CreateEntity(model, transform);
+
+    const VMVScene::ModelId model2{m_Scene.AddModel(VMVModel::CreateModelFromFile(
+        m_VMVDevice, "data/models/smooth_vase.obj", VMVModel::VertexFormat::Packed, false, &uploadBatch))};
+    Transform transform2{};
+    transform2.SetTranslation({0.5f, 0.5f, 2.5f});
+    transform2.SetScale({2.f, 2.f, 2.f});
+
+    m_Scene.CreateEntity(model2, transform2);
+
+
+    const VMVScene::ModelId model3{m_Scene2D.AddModel(VMVModel::CreateModelFromFile(
+        m_VMVDevice, "data/models/smooth_vase.obj", VMVModel::VertexFormat::Full, false, &uploadBatch))};
+    Transform transform3{};
+    transform3.SetTranslation({0.8f, 0.8f, 0.f});
+    transform3.SetScale({2.f, 2.f, 2.f});
 
-    m_GameObjects.push_back(std::move(gameObject));
+    m_Scene2D.CreateEntity(model3, transform3);
 
-    std::shared_ptr<VMVModel> model2{VMVModel::CreateModelFromFile(m_VMVDevice, "data/models/smooth_vase.obj")};
-    VMVGameObject gameObject2{VMVGameObject::CreateGameObject()};
-    gameObject2.m_Model = model2;
-    gameObject2.m_Transform.translation = {0.5f, 0.5f, 2.5f};
-    gameObject2.m_Transform.scale = {2.f, 2.f, 2.f};
+    uploadBatch.Submit();
+    uploadBatch.Wait();
 
-    m_GameObjects.push_back(std::move(gameObject2));
+    const float loadTime{duration<float, milliseconds::period>(high_resolution_clock::now() - start).count()};
+    std::cout << "Loaded scene in " << loadTime << "ms (" << uploadBatch.GetUploadCount() << " uploads, "
+              << uploadBatch.GetUploadedBytes() / 1024 << " KiB in one submission"
+              << (m_VMVDevice.hasDedicatedTransferQueue() ? " on the transfer queue" : "") << ")\n";
 
+    const VMVStagingRing::Stats& stagingStats{m_VMVDevice.getStagingRing().GetTotalStats()};
+    std::cout << "Staging ring: " << stagingStats.allocationCount << " allocations, " << stagingStats.fallbackCount
+              << " dedicated fallbacks, " << stagingStats.stallCount << " stalls, "
+              << stagingStats.stagedBytes / 1024 << " KiB staged\n";
 
-    std::shared_ptr<VMVModel> model3{VMVModel::CreateModelFromFile(m_VMVDevice, "data/models/smooth_vase.obj")};
-    VMVGameObject gameObject3{VMVGameObject::CreateGameObject()};
-    gameObject3.m_Model = model3;
-    gameObject3.m_Transform.translation = {0.8f, 0.8f, 0.f};
-    gameObject3.m_Transform.scale = {2.f, 2.f, 2.f};
+    const VMVMemoryAllocator::Stats memoryStats{m_VMVDevice.getMemoryAllocator().GetStats()};
+    std::cout << "Device memory: " << memoryStats.allocationCount << " allocations in " << memoryStats.blockCount
+              << " blocks + " << memoryStats.dedicatedAllocationCount << " dedicated, "
+              << memoryStats.usedBytes / 1024 << " / " << memoryStats.reservedBytes / 1024 << " KiB used, "
+              << memoryStats.fragmentation * 100.f << "% fragmentation\n";
 
-    m_GameObjects2D.push_back(std::move(gameObject3));
+    const VMVGeometryPool::Stats geometryStats{m_VMVDevice.getGeometryPool().GetStats()};
+    std::cout << "Geometry pool: " << geometryStats.rangeCount << " ranges in " << geometryStats.bufferCount
+              << " buffers, " << geometryStats.usedBytes / 1024 << " / " << geometryStats.capacityBytes / 1024
+              << " KiB used\n";
 }
@@ -6,12 +6,20 @@
 #include "Core/VMVGameObject.h"
 #include "Core/VMVModel.h"
 #include "Core/VMVRenderer.h"
+#include "Core/VMVScene.h"
 #include "Core/VMVWindow.h"
+#include <array>
+#include <chrono>
 #include <memory>
 #include <vector>
 
 namespace vmv
 {
+    class RenderSystem2D;
+    class SimpleRenderSystem;
+    class VMVThreadPool;
+    struct VMVFrameInfo;
+
     class VecmathVisualizer
     {
       public:
@@ -28,15 +36,50 @@ namespace vmv
 
         void Run();
 
+        // Uploads the loaded geometry in one batch and with a submit per buffer, then renders the first model at
+        // 1k/10k/100k objects in every SimpleRenderSystem draw mode and reports the CPU time spent recording draws
+        // per frame, then the binds of 10k objects of interleaved models with and without draw sorting, then the
+        // frame time of 100k objects of one mesh in full and packed vertices, then how recording 100k per object
+        // draws scales with the number of recording threads
+        void RunBenchmark();
+
+        // VMVScene::RunBenchmark with the loaded models
+        void RunSceneBenchmark() const;
+
       private:
+        // First so time to first frame includes creating the window and device
+        const std::chrono::high_resolution_clock::time_point m_StartTime{std::chrono::high_resolution_clock::now()};
+
         VMVWindow m_VMVWindow{WIDTH, HEIGHT, "Hello Vulkan!"};
         VMVDevice m_VMVDevice{m_VMVWindow};
         VMVRenderer m_VMVRenderer{m_VMVWindow, m_VMVDevice};
 
-        std::vector<VMVGameObject> m_GameObjects;
-        std::vector<VMVGameObject> m_GameObjects2D;
+        VMVScene m_Scene;
+        VMVScene m_Scene2D;
+
+        std::vector<VkCommandBuffer> m_SecondaryCommandBuffers;
+
+        static constexpr float STATS_LOG_INTERVAL{2.f}; // seconds
+        static constexpr int PARALLEL_RECORDING_KEY{GLFW_KEY_F1};
+        static constexpr int LATENCY_MODE_KEY{GLFW_KEY_F2};     // cycles the swap chain latency modes
+        static constexpr int FRAMES_IN_FLIGHT_KEY{GLFW_KEY_F3}; // cycles 1 to MAX_FRAMES_IN_FLIGHT
+        static constexpr int FRAME_RATE_LIMIT_KEY{GLFW_KEY_F4}; // cycles FRAME_RATE_LIMITS
+        static constexpr int DRAW_SORTING_KEY{GLFW_KEY_F5};
+        static constexpr std::array<float, 4> FRAME_RATE_LIMITS{0.f, 30.f, 60.f, 120.f}; // 0 is uncapped
+
+        void LoadScene();
+
+        // Time to first frame and once every pipeline compiled in the background, which is roughly when the first
+        // frame came out before the pipelines were compiled asynchronously
+        void LogStartupTime(const char* event);
 
-        void LoadGameObjects();
+        // Records the render pass of the current frame, into secondary command buffers on the thread pool's
+        // workers if one is given
+        void RecordScene(VMVFrameInfo& frameInfo,
+                         SimpleRenderSystem& renderSystem,
+                         RenderSystem2D* pRenderSystem2D,
+                         VMVScene& scene,
+                         VMVThreadPool* pThreadPool);
     };
 } // namespace vmv
 
@@ -1,15 +1,68 @@
 #include "VecmathVisualizer.h"
+#include "Core/VMVFrustumCuller.h"
+#include "Core/VMVGameObject.h"
+#include "Core/VMVMeshOptimizer.h"
+#include "Core/VMVModel.h"
+#include "Core/VMVTransformBatch.h"
 
 #include <cstdlib>
 #include <iostream>
+#include <string_view>
 
-int main()
+int main(int argc, char** argv)
 {
+    // CPU only, runs without opening a window
+    if (argc > 1 && std::string_view{argv[1]} == "--benchmark-culling")
+    {
+        vmv::VMVFrustumCuller::RunBenchmark(1'000'000);
+        return EXIT_SUCCESS;
+    }
+    if (argc > 1 && std::string_view{argv[1]} == "--benchmark-transforms")
+    {
+        vmv::Transform::RunBenchmark(1'000'000, .01f);
+        vmv::VMVTransformBatch::RunBenchmark(1'000'000);
+        return EXIT_SUCCESS;
+    }
+    if (argc > 1 && std::string_view{argv[1]} == "--benchmark-loader")
+    {
+        // Optional OBJ path, a generated grid otherwise
+        vmv::VMVModel::Builder::RunBenchmark(argc > 2 ? argv[2] : "");
+        return EXIT_SUCCESS;
+    }
+    if (argc > 1 && std::string_view{argv[1]} == "--benchmark-dedup")
+    {
+        vmv::VMVModel::Builder::RunDedupBenchmark(10'000'000);
+        return EXIT_SUCCESS;
+    }
+    if (argc > 2 && std::string_view{argv[1]} == "--analyze-mesh")
+    {
+        try
+        {
+            vmv::VMVMeshOptimizer::AnalyzeMesh(argv[2]);
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << e.what() << '\n';
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
     vmv::VecmathVisualizer app{};
 
     try
     {
-        app.Run();
+        if (argc > 1 && std::string_view{argv[1]} == "--benchmark")
+        {
+            app.RunBenchmark();
+        }
+        else if (argc > 1 && std::string_view{argv[1]} == "--benchmark-scene")
+        {
+            app.RunSceneBenchmark();
+        }
+        else
+        {
+            app.Run();
+        }
     }
     catch (const std::exception& e)
     {